@@ -0,0 +1,222 @@
+// Microbenchmarks for the runtime hot paths, run via `make bench`.
+// Each benchmark is run a few times after warmup and the best repetition
+// is reported as ns/op, so one scheduler hiccup does not skew a gate.
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define DEBUG(args...) {};
+
+#include "defs.h"
+#include "val.h"
+#include "ops.h"
+#include "echo.h"
+
+#define BENCH_WARMUP 2
+#define BENCH_REPS 5
+
+static int64_t sink = 0;
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+typedef uint64_t (*bench_fn)(void);
+
+static void run(const char *name, bench_fn fn, uint64_t ops) {
+    uint64_t best = UINT64_MAX;
+
+    for (int i = 0; i < BENCH_WARMUP + BENCH_REPS; i++) {
+        uint64_t ns = fn();
+
+        if (i >= BENCH_WARMUP && ns < best) {
+            best = ns;
+        }
+    }
+
+    printf("%-28s %10.1f ns/op\n", name, (double) best / (double) ops);
+}
+
+#define N_OPS 1000000
+
+static uint64_t bench_add_int() {
+    uint64_t t0 = now_ns();
+
+    for (int64_t i = 0; i < N_OPS; i++) {
+        val_t *v = val_op_add(new_int_val(i), new_int_val(7));
+
+        sink += val_as_i64(v);
+        free_val_if_ok(v);
+    }
+
+    return now_ns() - t0;
+}
+
+static uint64_t bench_add_int_int() {
+    uint64_t t0 = now_ns();
+
+    for (int64_t i = 0; i < N_OPS; i++) {
+        val_t *v = val_op_add_int_int(new_int_val(i), new_int_val(7));
+
+        sink += val_as_i64(v);
+        free_val_if_ok(v);
+    }
+
+    return now_ns() - t0;
+}
+
+static uint64_t bench_add_float() {
+    uint64_t t0 = now_ns();
+
+    for (int64_t i = 0; i < N_OPS; i++) {
+        val_t *v = val_op_add(new_float_val((double) i * 0.5), new_float_val(1.25));
+
+        sink += (int64_t) v->f64;
+        free_val_if_ok(v);
+    }
+
+    return now_ns() - t0;
+}
+
+static uint64_t bench_add_mixed() {
+    uint64_t t0 = now_ns();
+
+    for (int64_t i = 0; i < N_OPS; i++) {
+        val_t *v = val_op_add(new_int_val(i), new_float_val(1.25));
+
+        sink += (int64_t) v->f64;
+        free_val_if_ok(v);
+    }
+
+    return now_ns() - t0;
+}
+
+static uint64_t bench_array_push_int() {
+    val_t *arr = new_array_val(4);
+    uint64_t t0 = now_ns();
+
+    for (int64_t i = 0; i < N_OPS; i++) {
+        val_array_push(arr, new_int_val(i));
+    }
+
+    uint64_t ns = now_ns() - t0;
+    free_val_if_ok(arr);
+
+    return ns;
+}
+
+static uint64_t bench_array_push_str() {
+    val_t *arr = new_array_val(4);
+    uint64_t t0 = now_ns();
+
+    for (int64_t i = 0; i < N_OPS / 10; i++) {
+        val_array_push(arr, new_str_val("abc"));
+    }
+
+    uint64_t ns = now_ns() - t0;
+    free_val_if_ok(arr);
+
+    return ns;
+}
+
+static size_t bench_object_size = 8;
+
+static uint64_t bench_object_get() {
+    char keys[512][8];
+    val_t *obj = new_object_val();
+
+    for (size_t i = 0; i < bench_object_size; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "k%zu", i);
+        val_object_set(obj, keys[i], new_int_val((int64_t) i));
+    }
+
+    uint64_t t0 = now_ns();
+
+    for (int64_t i = 0; i < N_OPS; i++) {
+        val_t *v = val_object_get(obj, keys[i & (bench_object_size - 1)]);
+
+        sink += val_as_i64(v);
+    }
+
+    uint64_t ns = now_ns() - t0;
+    free_val_if_ok(obj);
+
+    return ns;
+}
+
+static uint64_t bench_str_combine_chain() {
+    val_t *s = new_str_val("seed string for the chain");
+    uint64_t t0 = now_ns();
+
+    for (int64_t i = 0; i < N_OPS / 10; i++) {
+        s = val_op_add(s, new_str_val("abcdefgh"));
+    }
+
+    uint64_t ns = now_ns() - t0;
+
+    sink += (int64_t) s->str.len;
+    free_val_if_ok(s);
+
+    return ns;
+}
+
+// echo writes straight to fd 1, so it is pointed at /dev/null for the
+// timed call — the terminal would otherwise dominate the numbers.
+static uint64_t bench_echo_large_array() {
+    val_t *arr = new_array_val(4);
+
+    for (int64_t i = 0; i < N_OPS; i++) {
+        val_array_push(arr, new_int_val(i));
+    }
+
+    fflush(stdout);
+
+    int real_stdout = dup(1);
+    int devnull = open("/dev/null", O_WRONLY);
+    dup2(devnull, 1);
+
+    uint64_t t0 = now_ns();
+    echo(arr);
+    uint64_t ns = now_ns() - t0;
+
+    dup2(real_stdout, 1);
+    close(real_stdout);
+    close(devnull);
+
+    return ns;
+}
+
+int main() {
+    run("val_op_add int+int", bench_add_int, N_OPS);
+    run("val_op_add_int_int", bench_add_int_int, N_OPS);
+    run("val_op_add float+float", bench_add_float, N_OPS);
+    run("val_op_add int+float", bench_add_mixed, N_OPS);
+
+    run("array_push int", bench_array_push_int, N_OPS);
+    run("array_push str", bench_array_push_str, N_OPS / 10);
+
+    bench_object_size = 8;
+    run("object_get (8 keys)", bench_object_get, N_OPS);
+    bench_object_size = 64;
+    run("object_get (64 keys)", bench_object_get, N_OPS);
+    bench_object_size = 512;
+    run("object_get (512 keys)", bench_object_get, N_OPS);
+
+    run("str_combine chain", bench_str_combine_chain, N_OPS / 10);
+
+    run("echo 1M int array", bench_echo_large_array, N_OPS);
+
+    fprintf(stderr, "sink: %lld\n", (long long) sink);
+
+    return 0;
+}
@@ -0,0 +1,33 @@
+declare function echo(...s: any[]): void;
+
+let a = 3 * 7 + 2 - 1;
+let b = a * a - 17;
+let c = b * 3 + a * 5;
+let d = c - b * 2 + 11;
+let e = d * d - c * a;
+echo(a, b, c, d, e);
+
+let f = e * 2 + d * 3 - c;
+let g = f - e + d - c + b - a;
+let h = g * 7 + f * 5 + e * 3;
+echo(f, g, h);
+
+echo(a < b);
+echo(c < d);
+echo(e < f);
+echo(!(g < h));
+
+let p = 1.5 * 4.0 + 2.25;
+let q = p * p - 3.125;
+let r = q * 0.5 + p * 2.0;
+echo(p, q, r);
+
+echo(typeof a);
+echo(typeof p);
+echo(typeof -3);
+
+let s = h * 11 - g * 13 + f * 17;
+let t = s - h * 19 + g * 23;
+let u = t * 29 - s * 31;
+echo(s, t, u);
+echo(u < s);
@@ -0,0 +1,23 @@
+declare function echo(...s: any[]): void;
+
+let user = { id: 10, name: 'merhaba', active: true };
+let pos = { x: 12, y: 34 };
+let mix = { n: 1.5, s: 'selam', inner: 7 };
+echo(user);
+echo(pos);
+echo(mix);
+
+let greeting = 'selam' + ' ' + 'dunya';
+let banner = greeting + '!' + '!';
+let line = banner + ' -- ' + greeting;
+echo(greeting);
+echo(banner);
+echo(line);
+
+echo(typeof user);
+echo(typeof greeting);
+
+let doubled = { a: 2 * 2, b: 3 * 3, c: 4 * 4 };
+let summed = { lo: 1 + 2 + 3, hi: 100 + 200 + 300 };
+echo(doubled);
+echo(summed);
@@ -53,6 +53,21 @@ pub fn create_builtin_functions<'ctx>(
 
     map.insert("new_object_val", val_type.fn_type(&[], false));
 
+    map.insert(
+        "val_array_reserve",
+        val_type.fn_type(&[val_type.into(), context.i64_type().into()], false),
+    );
+
+    map.insert(
+        "val_array_clone",
+        val_type.fn_type(&[val_type.into()], false),
+    );
+
+    map.insert(
+        "val_object_clone",
+        val_type.fn_type(&[val_type.into()], false),
+    );
+
     map.insert(
         "val_op_add",
         val_type.fn_type(&[val_type.into(), val_type.into()], false),
@@ -122,6 +137,40 @@ pub fn create_builtin_functions<'ctx>(
         val_type.fn_type(&[val_type.into(), val_type.into()], false),
     );
 
+    // Monomorphic variants emitted by --optimize when both operand types
+    // are statically known (see std/ops.h).
+    for name in [
+        "val_op_add_int_int",
+        "val_op_sub_int_int",
+        "val_op_mul_int_int",
+        "val_op_mod_int_int",
+        "val_op_add_f64_f64",
+        "val_op_sub_f64_f64",
+        "val_op_mul_f64_f64",
+        "val_op_div_f64_f64",
+        "val_op_lt_int_int",
+        "val_op_lte_int_int",
+        "val_op_gt_int_int",
+        "val_op_gte_int_int",
+        "val_op_eq_int_int",
+        "val_op_neq_int_int",
+    ] {
+        map.insert(name, val_type.fn_type(&[val_type.into(), val_type.into()], false));
+    }
+
+    // Caller-provided result storage: out slot first, then the operands.
+    for name in [
+        "val_op_add_f64_f64_into",
+        "val_op_sub_f64_f64_into",
+        "val_op_mul_f64_f64_into",
+        "val_op_div_f64_f64_into",
+    ] {
+        map.insert(
+            name,
+            val_type.fn_type(&[val_type.into(), val_type.into(), val_type.into()], false),
+        );
+    }
+
     map.insert(
         "val_array_push",
         val_type.fn_type(&[val_type.into(), val_type.into()], false),
@@ -150,6 +199,18 @@ pub fn create_builtin_functions<'ctx>(
         ),
     );
 
+    map.insert(
+        "val_object_get_ic",
+        val_type.fn_type(
+            &[
+                val_type.into(),
+                context.i8_type().ptr_type(AddressSpace::default()).into(),
+                context.i8_type().ptr_type(AddressSpace::default()).into(),
+            ],
+            false,
+        ),
+    );
+
     map.insert("link_val", val_type.fn_type(&[val_type.into()], false));
     map.insert("unlink_val", val_type.fn_type(&[val_type.into()], false));
 
@@ -9,6 +9,7 @@ use inkwell::module::{Linkage, Module};
 use inkwell::targets::{CodeModel, InitializationConfig, RelocMode, Target, TargetTriple};
 use inkwell::types::{BasicType, BasicTypeEnum, FunctionType};
 use inkwell::values::{BasicMetadataValueEnum, BasicValueEnum, FunctionValue, PointerValue};
+use inkwell::AddressSpace;
 use inkwell::OptimizationLevel;
 
 use crate::ast;
@@ -18,6 +19,18 @@ use crate::st;
 
 const MAIN_FUNCTION_NAME: &str = "main";
 
+// Mirrors the runtime's val_t protocol for statics (std/defs.h): a box
+// whose ref_count is the VAL_STATIC_REF sentinel is never linked,
+// unlinked or freed, so literal boxes can live in .rodata.
+const VAL_STR_TYPE_ID: u64 = 4;
+const VAL_STATIC_REF: u64 = 0x8000_0000;
+
+#[derive(Clone, Copy, PartialEq)]
+enum StaticNumKind {
+    Int,
+    Float,
+}
+
 fn new_function_label() -> String {
     static FUNCTION_COUNTER: AtomicUsize = AtomicUsize::new(0);
 
@@ -90,7 +103,9 @@ impl<'input, 'ctx> IRGenerator<'input, 'ctx> {
             "",
             "",
             OptimizationLevel::None,
-            RelocMode::Default,
+            // PIC keeps global accesses relocation-free in .text; the
+            // host toolchain links everything as PIE.
+            RelocMode::PIC,
             CodeModel::Default,
         );
 
@@ -373,6 +388,95 @@ impl<'input, 'ctx> IRGenerator<'input, 'ctx> {
         Ok(())
     }
 
+    // Conservative numeric class of an expression, used to pick a
+    // monomorphic op. Only shapes the generator can prove locally count;
+    // anything involving variables or calls is unknown.
+    fn static_num_kind(expression: &ast::Expression<'input>) -> Option<StaticNumKind> {
+        match expression {
+            ast::Expression::ConstantExpression { value, .. } => match value {
+                ast::Constant::Integer(_) => Some(StaticNumKind::Int),
+                ast::Constant::Float(_) => Some(StaticNumKind::Float),
+                _ => None,
+            },
+
+            ast::Expression::UnaryExpression {
+                operator: ast::UnaryOperator::Negative | ast::UnaryOperator::Positive,
+                expression: e,
+                ..
+            } => Self::static_num_kind(e),
+
+            ast::Expression::BinaryExpression {
+                operator,
+                left,
+                right,
+                ..
+            } => {
+                let left = Self::static_num_kind(left)?;
+                let right = Self::static_num_kind(right)?;
+
+                match operator {
+                    ast::BinaryOperator::Addition
+                    | ast::BinaryOperator::Subtraction
+                    | ast::BinaryOperator::Multiplication => {
+                        if left == StaticNumKind::Int && right == StaticNumKind::Int {
+                            Some(StaticNumKind::Int)
+                        } else {
+                            Some(StaticNumKind::Float)
+                        }
+                    }
+                    ast::BinaryOperator::Division => Some(StaticNumKind::Float),
+                    ast::BinaryOperator::Mod => {
+                        if left == StaticNumKind::Int && right == StaticNumKind::Int {
+                            Some(StaticNumKind::Int)
+                        } else {
+                            None
+                        }
+                    }
+                    _ => None,
+                }
+            }
+
+            _ => None,
+        }
+    }
+
+    // Returns the specialized builtin for this operator when both operand
+    // types are known, or None to fall back to the generic dispatching op.
+    fn specialized_binary_builtin(
+        operator: &ast::BinaryOperator,
+        left: &ast::Expression<'input>,
+        right: &ast::Expression<'input>,
+    ) -> Option<&'static str> {
+        let left = Self::static_num_kind(left)?;
+        let right = Self::static_num_kind(right)?;
+
+        if left == StaticNumKind::Int && right == StaticNumKind::Int {
+            match operator {
+                ast::BinaryOperator::Addition => Some("val_op_add_int_int"),
+                ast::BinaryOperator::Subtraction => Some("val_op_sub_int_int"),
+                ast::BinaryOperator::Multiplication => Some("val_op_mul_int_int"),
+                ast::BinaryOperator::Mod => Some("val_op_mod_int_int"),
+                ast::BinaryOperator::Less => Some("val_op_lt_int_int"),
+                ast::BinaryOperator::LessEqual => Some("val_op_lte_int_int"),
+                ast::BinaryOperator::Greater => Some("val_op_gt_int_int"),
+                ast::BinaryOperator::GreaterEqual => Some("val_op_gte_int_int"),
+                ast::BinaryOperator::Equal => Some("val_op_eq_int_int"),
+                ast::BinaryOperator::NotEqual => Some("val_op_neq_int_int"),
+                _ => None,
+            }
+        } else if left == StaticNumKind::Float && right == StaticNumKind::Float {
+            match operator {
+                ast::BinaryOperator::Addition => Some("val_op_add_f64_f64"),
+                ast::BinaryOperator::Subtraction => Some("val_op_sub_f64_f64"),
+                ast::BinaryOperator::Multiplication => Some("val_op_mul_f64_f64"),
+                ast::BinaryOperator::Division => Some("val_op_div_f64_f64"),
+                _ => None,
+            }
+        } else {
+            None
+        }
+    }
+
     fn translate_binary_expression(
         &self,
         expression: &'input ast::Expression<'input>,
@@ -402,8 +506,15 @@ impl<'input, 'ctx> IRGenerator<'input, 'ctx> {
                 ast::BinaryOperator::Or => "val_op_or",
             };
 
-            let left = self.translate_expression(left)?.into_pointer_value();
-            let right = self.translate_expression(right)?.into_pointer_value();
+            let builtin_func_name = if self.optimize {
+                Self::specialized_binary_builtin(operator, left, right)
+                    .unwrap_or(builtin_func_name)
+            } else {
+                builtin_func_name
+            };
+
+            let left = self.translate_operand_expression(left)?.into_pointer_value();
+            let right = self.translate_operand_expression(right)?.into_pointer_value();
 
             let result = self
                 .call_builtin(builtin_func_name, &[left.into(), right.into()])?
@@ -415,6 +526,58 @@ impl<'input, 'ctx> IRGenerator<'input, 'ctx> {
         }
     }
 
+    // Translates an expression appearing in operand position. Under
+    // --optimize a float-specialized sub-expression writes its result
+    // into a stack slot via the _into variant instead of a heap box:
+    // the parent op consumes the temporary immediately, so it never
+    // escapes the frame. Everything else falls back to the normal path.
+    fn translate_operand_expression(
+        &self,
+        expression: &'input ast::Expression<'input>,
+    ) -> Result<BasicValueEnum<'ctx>, CompilerError<'input>> {
+        if self.optimize {
+            if let ast::Expression::BinaryExpression {
+                operator,
+                left,
+                right,
+                ..
+            } = expression
+            {
+                let into_name = match Self::specialized_binary_builtin(operator, left, right) {
+                    Some("val_op_add_f64_f64") => Some("val_op_add_f64_f64_into"),
+                    Some("val_op_sub_f64_f64") => Some("val_op_sub_f64_f64_into"),
+                    Some("val_op_mul_f64_f64") => Some("val_op_mul_f64_f64_into"),
+                    Some("val_op_div_f64_f64") => Some("val_op_div_f64_f64_into"),
+                    _ => None,
+                };
+
+                if let Some(into_name) = into_name {
+                    // 56 bytes, the runtime's sizeof(val_t) (see defs.h).
+                    let slot_type = self.context.i64_type().array_type(7);
+                    let slot = self.builder.build_alloca(slot_type, "tmp_val");
+                    let slot = self
+                        .builder
+                        .build_bitcast(slot, self.val_type, "tmp_val_ptr")
+                        .into_pointer_value();
+
+                    let left_v = self.translate_operand_expression(left)?.into_pointer_value();
+                    let right_v = self.translate_operand_expression(right)?.into_pointer_value();
+
+                    let result = self
+                        .call_builtin(
+                            into_name,
+                            &[slot.into(), left_v.into(), right_v.into()],
+                        )?
+                        .into_pointer_value();
+
+                    return Ok(result.into());
+                }
+            }
+        }
+
+        self.translate_expression(expression)
+    }
+
     fn translate_unary_expression(
         &self,
         expression: &'input ast::Expression<'input>,
@@ -588,9 +751,49 @@ impl<'input, 'ctx> IRGenerator<'input, 'ctx> {
                 }
 
                 ast::Constant::String(data) => {
+                    // String literals never change, so instead of calling
+                    // new_str_val per evaluation we emit a static val_t
+                    // (type, sentinel ref_count, str header) pointing at
+                    // the literal bytes and just take its address.
                     let s = self.builder.build_global_string_ptr(data, "string");
 
-                    let v = self.call_builtin("new_str_val", &[s.as_pointer_value().into()])?;
+                    let i32_type = self.context.i32_type();
+                    let i64_type = self.context.i64_type();
+                    let bytes_ptr_type = self.context.i8_type().ptr_type(AddressSpace::default());
+
+                    let str_val_type = self.context.struct_type(
+                        &[
+                            i32_type.into(),       // val_t.type
+                            i32_type.into(),       // val_t.ref_count
+                            i64_type.into(),       // str_t.len
+                            i64_type.into(),       // str_t.capacity
+                            bytes_ptr_type.into(), // str_t.data
+                        ],
+                        false,
+                    );
+
+                    let initializer = str_val_type.const_named_struct(&[
+                        i32_type.const_int(VAL_STR_TYPE_ID, false).into(),
+                        i32_type.const_int(VAL_STATIC_REF, false).into(),
+                        i64_type.const_int(data.len() as u64, false).into(),
+                        i64_type.const_zero().into(),
+                        s.as_pointer_value().into(),
+                    ]);
+
+                    let global = self.module.add_global(str_val_type, None, "string_val");
+                    global.set_initializer(&initializer);
+                    // Not marked constant: the initializer embeds the
+                    // address of the literal bytes, which needs a load-time
+                    // relocation. As a constant it would land in .rodata and
+                    // the linker would emit a DT_TEXTREL warning; this way
+                    // it goes to .data.rel.ro instead.
+                    global.set_linkage(Linkage::Private);
+
+                    let v = self.builder.build_bitcast(
+                        global.as_pointer_value(),
+                        self.val_type,
+                        "tmp",
+                    );
 
                     Ok(v.into())
                 }
@@ -0,0 +1,96 @@
+#ifndef MINI_STD_ARENA_H
+#define MINI_STD_ARENA_H
+
+#include "defs.h"
+
+// MINI_ARENA switches the runtime to region allocation: every string,
+// array and object buffer is bump-allocated from a chunk list and
+// nothing is freed individually — mini_arena_reset (gc.h) releases the
+// whole heap in one sweep. Short-lived programs and request-per-arena
+// embeddings skip all per-value free traffic this way. The default
+// build maps the shims straight to malloc/realloc/free.
+#ifdef MINI_ARENA
+
+#ifdef MINI_DEFERRED_RC
+#error "MINI_ARENA and MINI_DEFERRED_RC cannot be combined"
+#endif
+
+#define ARENA_CHUNK_SIZE (256 * 1024)
+
+typedef struct arena_chunk {
+    struct arena_chunk *next;
+    size_t used;
+    size_t capacity;
+    char data[];
+} arena_chunk_t;
+
+static arena_chunk_t *arena_chunks = NULL;
+
+static void *mini_alloc(size_t size) {
+    size = (size + 7) & ~(size_t) 7;
+
+    if (arena_chunks == NULL || arena_chunks->used + size > arena_chunks->capacity) {
+        size_t capacity = size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE;
+
+        arena_chunk_t *chunk = malloc(sizeof(arena_chunk_t) + capacity);
+        chunk->next = arena_chunks;
+        chunk->used = 0;
+        chunk->capacity = capacity;
+
+        arena_chunks = chunk;
+
+        DEBUG("ARENA: new chunk: %p", chunk);
+    }
+
+    void *p = arena_chunks->data + arena_chunks->used;
+    arena_chunks->used += size;
+
+    return p;
+}
+
+static void mini_free(void *p) {
+    (void) p;
+}
+
+// Growing the most recent allocation extends it in place; anything else
+// moves to a fresh block and the old bytes stay parked until reset.
+static void *mini_realloc(void *p, size_t old_size, size_t new_size) {
+    if (p == NULL) {
+        return mini_alloc(new_size);
+    }
+
+    old_size = (old_size + 7) & ~(size_t) 7;
+    size_t aligned = (new_size + 7) & ~(size_t) 7;
+
+    if (arena_chunks != NULL && (char *) p + old_size == arena_chunks->data + arena_chunks->used
+        && arena_chunks->used - old_size + aligned <= arena_chunks->capacity) {
+        arena_chunks->used += aligned - old_size;
+
+        return p;
+    }
+
+    void *q = mini_alloc(new_size);
+    memcpy(q, p, old_size < new_size ? old_size : new_size);
+
+    return q;
+}
+
+#else
+
+static inline void *mini_alloc(size_t size) {
+    return malloc(size);
+}
+
+static inline void mini_free(void *p) {
+    free(p);
+}
+
+static inline void *mini_realloc(void *p, size_t old_size, size_t new_size) {
+    (void) old_size;
+
+    return realloc(p, new_size);
+}
+
+#endif
+
+#endif
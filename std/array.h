@@ -2,26 +2,85 @@
 #define MINI_STD_ARRAY_H
 
 #include "defs.h"
+#include "arena.h"
+#include "cow.h"
+#include "counters.h"
+#include "stats.h"
 
 void link_val(val_t *val);
 void unlink_val(val_t *val);
 
+static inline bool array_is_inline(array_t *s) {
+    return s->data == s->inline_data;
+}
+
 static void free_array(array_t *s) {
-    free(s->data);
+    if (!array_is_inline(s)) {
+        mini_free(s->data);
+    }
 }
 
 static void new_array(array_t *result, uint64_t capacity) {
-    void **data = malloc(capacity * sizeof(void *));
+    result->shared = NULL;
+
+    if (capacity <= ARRAY_INLINE_CAPACITY) {
+        result->capacity = ARRAY_INLINE_CAPACITY;
+        result->len = 0;
+        result->data = result->inline_data;
+
+        return;
+    }
+
+    void **data = mini_alloc(capacity * sizeof(void *));
+
+    STATS_ADD(stats_array_bytes, capacity * sizeof(void *));
 
     result->capacity = capacity;
     result->len = 0;
     result->data = data;
 }
 
+// Growth policy: 1.5x with a minimum step, so tiny arrays reach useful
+// sizes in one realloc instead of crawling (and a zero capacity cannot
+// stall), while large arrays grow their footprint by half rather than
+// doubling it. Spilling out of the inline buffer copies the elements
+// into a fresh heap block; every element form (pointer, int64, double)
+// is the same 8 bytes, so the policy is shared across representations.
+#define ARRAY_GROW_MIN 8
+
+static void array_grow(array_t *result, size_t needed) {
+    // Shared blocks are read-only; callers unshare before growing.
+    assert(result->shared == NULL);
+
+    size_t capacity = result->capacity + result->capacity / 2;
+
+    if (capacity < ARRAY_GROW_MIN) {
+        capacity = ARRAY_GROW_MIN;
+    }
+    if (capacity < needed) {
+        capacity = needed;
+    }
+
+    if (array_is_inline(result)) {
+        void **data = mini_alloc(capacity * sizeof(void *));
+
+        memcpy(data, result->inline_data, result->len * sizeof(void *));
+        result->data = data;
+    } else {
+        result->data = mini_realloc(result->data, result->capacity * sizeof(void *), capacity * sizeof(void *));
+    }
+
+    STATS_ADD(stats_array_bytes, (capacity - result->capacity) * sizeof(void *));
+    STATS_ADD(stats_array_reallocs, 1);
+
+    result->capacity = capacity;
+}
+
 static void array_push(array_t *result, void *v) {
+    COUNT(COUNTER_PUSH);
+
     if (result->len == result->capacity) {
-        result->capacity *= 2;
-        result->data = realloc(result->data, result->capacity * sizeof(void *));
+        array_grow(result, result->len + 1);
     }
 
     result->data[result->len] = v;
@@ -30,4 +89,37 @@ static void array_push(array_t *result, void *v) {
     DEBUG("ARRAY: push: %p, %p", result, v);
 }
 
+// Makes room for extra more elements in one step.
+static void array_reserve(array_t *result, size_t extra) {
+    size_t needed = result->len + extra;
+
+    if (needed <= result->capacity) {
+        return;
+    }
+
+    array_grow(result, needed);
+}
+
+static void array_push_i64(array_t *result, int64_t v) {
+    COUNT(COUNTER_PUSH);
+
+    if (result->len == result->capacity) {
+        array_grow(result, result->len + 1);
+    }
+
+    ((int64_t *) result->data)[result->len] = v;
+    result->len++;
+}
+
+static void array_push_f64(array_t *result, double v) {
+    COUNT(COUNTER_PUSH);
+
+    if (result->len == result->capacity) {
+        array_grow(result, result->len + 1);
+    }
+
+    ((double *) result->data)[result->len] = v;
+    result->len++;
+}
+
 #endif
@@ -0,0 +1,49 @@
+#ifndef MINI_STD_COW_H
+#define MINI_STD_COW_H
+
+#include "defs.h"
+#include "arena.h"
+
+// Copy-on-write sharing for array data and object vals blocks. A clone
+// attaches a cow_buf_t side header to the block and both boxes view it
+// through the same pointer, so the handoff is O(1) regardless of size.
+// The block is treated as read-only while shared; the mutation entry
+// points in ops.h duplicate it first (val_array_unshare /
+// val_object_unshare). Boxed element refcounts are per block, not per
+// view: only the view that ends up owning the block unlinks them.
+
+static cow_buf_t *cow_buf_new(void **data) {
+    cow_buf_t *buf = mini_alloc(sizeof(cow_buf_t));
+
+    buf->ref_count = 1;
+    buf->data = data;
+
+    return buf;
+}
+
+static void cow_buf_retain(cow_buf_t *buf) {
+#ifdef MINI_THREADS
+    __atomic_add_fetch(&buf->ref_count, 1, __ATOMIC_ACQ_REL);
+#else
+    buf->ref_count++;
+#endif
+}
+
+// Drops one view; returns true when the caller held the last one and
+// now owns the block. The header itself is freed either way once the
+// count hits zero.
+static bool cow_buf_release(cow_buf_t *buf) {
+#ifdef MINI_THREADS
+    bool last = __atomic_sub_fetch(&buf->ref_count, 1, __ATOMIC_ACQ_REL) == 0;
+#else
+    bool last = --buf->ref_count == 0;
+#endif
+
+    if (last) {
+        mini_free(buf);
+    }
+
+    return last;
+}
+
+#endif
@@ -1,22 +1,88 @@
 #ifndef MINI_STD_DEFS_H
 #define MINI_STD_DEFS_H
 
+// MINI_THREADS builds the runtime for sharded execution: allocation
+// state (val pool, string free lists, GC worklist) becomes thread-local,
+// refcounts and the live counter go atomic (gc.h), and the shared
+// immortal structures — the intern table and shape transitions — take a
+// coarse mutex (intern.h). See parallel.h for the cross-thread
+// ownership rule.
+#ifdef MINI_THREADS
+#define MINI_TLS __thread
+#else
+#define MINI_TLS
+#endif
+
+// Heap string storage is a refcounted shared buffer, so slice views can
+// point into a parent's bytes without copying and outlive the parent box.
+// capacity records the allocated payload size, which lets dead buffers be
+// recycled through per-size-class free lists (see str.h). hash caches the
+// content hash of the string heading the buffer (0 = not yet computed,
+// invalidated on append).
+typedef struct {
+    uint64_t capacity;
+    uint32_t ref_count;
+    uint32_t hash;
+    char data[];
+} str_buf_t;
+
+// Strings shorter than STR_INLINE_CAPACITY live in inline_data inside the
+// box itself; data always points at the bytes (inline, owned buffer or
+// slice view), so readers never branch. capacity == 0 marks an immutable
+// slice view; owner overlays the inline space, since a string is either
+// inline or buffer-backed, never both.
+#define STR_INLINE_CAPACITY 24
+
 typedef struct {
     uint64_t len;
+    uint64_t capacity;
     char *data;
+    union {
+        char inline_data[STR_INLINE_CAPACITY];
+        str_buf_t *owner;
+    };
 } str_t;
 
+// Side header for element storage shared between clones (copy-on-write,
+// see cow.h): counts the boxes viewing one block. A NULL shared pointer
+// in the owning struct means the block is exclusively owned.
+typedef struct {
+    uint32_t ref_count;
+    void **data;
+} cow_buf_t;
+
+// Arrays of up to ARRAY_INLINE_CAPACITY elements keep them in
+// inline_data inside the box itself, so short arrays never allocate a
+// data block. data always points at the elements (inline or heap), so
+// readers never branch; data == inline_data marks the inline form.
+#define ARRAY_INLINE_CAPACITY 2
+
 typedef struct {
     size_t capacity;
     size_t len;
     void **data;
+    cow_buf_t *shared;
+    void *inline_data[ARRAY_INLINE_CAPACITY];
 } array_t;
 
+// One open-addressing index slot: the cached key hash plus the slot the
+// key occupies. OBJECT_SLOT_EMPTY marks unused slots.
 typedef struct {
+    uint32_t hash;
+    uint32_t entry;
+} object_slot_t;
+
+// Objects built with the same key insertion order share one shape
+// (hidden class, see object.h) that owns the keys and the key -> slot
+// index; the object itself carries only its vals slots.
+typedef struct object_shape object_shape_t;
+
+typedef struct {
+    object_shape_t *shape;
     size_t capacity;
     size_t len;
-    char **keys;
     void **vals;
+    cow_buf_t *shared;
 } object_t;
 
 typedef enum  {
@@ -27,6 +93,11 @@ typedef enum  {
     VAL_STR,
     VAL_ARRAY,
     VAL_OBJECT,
+    // Unboxed arrays: data holds contiguous int64_t/double elements
+    // instead of val_t* boxes. A push of anything else promotes the
+    // array to the boxed VAL_ARRAY form.
+    VAL_INT_ARRAY,
+    VAL_FLOAT_ARRAY,
 } val_type_t;
 
 typedef struct {
@@ -42,4 +113,54 @@ typedef struct {
     };
 } val_t;
 
+// Generated code reserves fixed-size stack slots for non-escaping
+// temporaries (translate_operand_expression in gen.rs); the slot size is
+// baked in there.
+_Static_assert(sizeof(val_t) == 56, "val_t size is baked into generated stack slots");
+
+// Ints that fit in 63 bits are not boxed at all: they travel as a val_t*
+// with the low bit set and the value in the upper bits. Heap pointers are
+// 8-byte aligned, so the bit is unambiguous. Always go through the
+// accessors below instead of touching ->type / ->i64 directly.
+#define VAL_INT_TAG 1
+
+#define VAL_TAGGED_INT_MIN (INT64_MIN >> 1)
+#define VAL_TAGGED_INT_MAX (INT64_MAX >> 1)
+
+static inline bool val_is_tagged(val_t *v) {
+#ifdef MINI_BOXED_INTS
+    return false;
+#else
+    return ((uintptr_t) v & VAL_INT_TAG) != 0;
+#endif
+}
+
+// Statics (interned ints, the null/bool singletons and future pooled
+// literals) carry this sentinel ref_count so link/unlink/free leave
+// them alone.
+#define VAL_STATIC_REF INT32_MIN
+
+// Reads of ref_count off the owning thread go through a relaxed atomic
+// load under MINI_THREADS so they pair cleanly with the atomic updates
+// in gc.h.
+static inline int32_t val_ref_count(val_t *v) {
+#ifdef MINI_THREADS
+    return __atomic_load_n(&v->ref_count, __ATOMIC_RELAXED);
+#else
+    return v->ref_count;
+#endif
+}
+
+static inline bool val_is_static(val_t *v) {
+    return val_ref_count(v) == VAL_STATIC_REF;
+}
+
+static inline val_type_t val_type_of(val_t *v) {
+    return val_is_tagged(v) ? VAL_INT : v->type;
+}
+
+static inline int64_t val_as_i64(val_t *v) {
+    return val_is_tagged(v) ? ((int64_t) v >> 1) : v->i64;
+}
+
 #endif
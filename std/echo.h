@@ -5,135 +5,298 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "val.h"
+#include "fmt.h"
 
 #define MAX_FLOAT_LEN 256
-#define MAX_FLOAT_PRECISION 6
 
-static void echo_internal(val_t *v);
+#define ECHO_BUF_SIZE 8192
 
-static void echo_float(double f64) {
-    char buf[MAX_FLOAT_LEN];
-    snprintf(buf, MAX_FLOAT_LEN, "%.6f", f64);
+// Output is staged in one buffer and flushed to fd 1 in large writes,
+// instead of one printf per element and escape sequence. Color escapes
+// are only emitted when stdout is a terminal, resolved once at first use.
+static char echo_buf[ECHO_BUF_SIZE];
+static size_t echo_buf_len = 0;
+static int echo_colors = -1;
+
+static bool echo_use_colors() {
+    if (echo_colors < 0) {
+        echo_colors = isatty(1);
+    }
 
-    size_t len = strlen(buf);
+    return echo_colors != 0;
+}
 
-    buf[len - MAX_FLOAT_PRECISION - 1] = 0;
+static void echo_flush() {
+    size_t off = 0;
 
-    int32_t index = MAX_FLOAT_PRECISION;
-    while (index > 0) {
-        if (buf[len - index] == '0') {
-            buf[len - index] = 0;
+    while (off < echo_buf_len) {
+        ssize_t n = write(1, echo_buf + off, echo_buf_len - off);
+        if (n < 0) {
             break;
         }
 
-        index -= 1;
+        off += (size_t) n;
     }
 
-    if (index == MAX_FLOAT_PRECISION) {
-        printf("\x1B[0;33m" "%s" "\x1B[0m", buf);
-    } else {
-        printf("\x1B[0;33m" "%s.%s" "\x1B[0m", buf, &buf[len - MAX_FLOAT_PRECISION]);
-    }
+    echo_buf_len = 0;
 }
 
-static void echo_array(array_t *items) {
-    if (items->len == 0) {
-        printf("[]");
+static void echo_write(const char *data, size_t len) {
+    if (echo_buf_len + len > ECHO_BUF_SIZE) {
+        echo_flush();
+    }
+
+    if (len > ECHO_BUF_SIZE) {
+        // Larger than the whole buffer: hand it to the kernel directly.
+        size_t off = 0;
+
+        while (off < len) {
+            ssize_t n = write(1, data + off, len - off);
+            if (n < 0) {
+                break;
+            }
+
+            off += (size_t) n;
+        }
+
         return;
     }
 
-    printf("[ ");
+    memcpy(echo_buf + echo_buf_len, data, len);
+    echo_buf_len += len;
+}
 
-    for (uint64_t i = 0; i < items->len; i++) {
-        val_t *v = (val_t *) items->data[i];
+static void echo_cstr(const char *s) {
+    echo_write(s, strlen(s));
+}
 
-        echo_internal(v);
+static void echo_color(const char *code) {
+    if (echo_use_colors()) {
+        echo_cstr(code);
+    }
+}
 
-        if (i < items->len - 1) {
-            printf(", ");
-        }
+static void echo_internal(val_t *v);
+
+// Rendering limits, resolved once from the environment like the color
+// probe: MINI_ECHO_DEPTH bounds nesting (deeper containers render as
+// […] / {…}), MINI_ECHO_ITEMS bounds elements shown per container
+// (the rest elide to …). 0 or unset means unlimited, which keeps the
+// default output byte-identical.
+static int64_t echo_max_depth = -1;
+static int64_t echo_max_items = -1;
+
+static int64_t echo_env_limit(const char *name) {
+    char *env = getenv(name);
+
+    return env != NULL ? strtoll(env, NULL, 10) : 0;
+}
+
+static int64_t echo_depth_limit() {
+    if (echo_max_depth < 0) {
+        echo_max_depth = echo_env_limit("MINI_ECHO_DEPTH");
     }
 
-    printf(" ]");
+    return echo_max_depth;
 }
 
-static void echo_object(object_t *kv) {
-    if (kv->len == 0) {
-        printf("{}");
-        return;
+static int64_t echo_items_limit() {
+    if (echo_max_items < 0) {
+        echo_max_items = echo_env_limit("MINI_ECHO_ITEMS");
     }
 
-    printf("{ ");
+    return echo_max_items;
+}
 
-    for (uint64_t i = 0; i < kv->len; i++) {
-        char *k = kv->keys[i];
-        val_t *v = (val_t *) kv->vals[i];
+static void echo_i64(int64_t n) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%lld", (long long) n);
 
-        printf("%s: ", k);
-        echo_internal(v);
+    echo_color("\x1B[0;33m");
+    echo_cstr(buf);
+    echo_color("\x1B[0m");
+}
 
-        if (i < kv->len - 1) {
-            printf(", ");
-        }
+static void echo_float(double f64) {
+    char buf[MAX_FLOAT_LEN];
+    size_t len = fmt_f64(buf, sizeof(buf), f64);
+
+    echo_color("\x1B[0;33m");
+    echo_write(buf, len);
+    echo_color("\x1B[0m");
+}
+
+// Container rendering is driven by an explicit frame stack instead of
+// recursion, so a 10k-deep tree cannot overflow the call stack: each
+// frame remembers how far through its container it is and how many
+// elements it may still show before eliding.
+#define ECHO_STACK_INITIAL_CAPACITY 32
+
+typedef struct {
+    val_t *v;
+    uint64_t index;
+    uint64_t render;
+} echo_frame_t;
+
+static echo_frame_t *echo_stack = NULL;
+static size_t echo_stack_len = 0;
+static size_t echo_stack_capacity = 0;
+
+static uint64_t echo_container_len(val_t *v) {
+    return val_type_of(v) == VAL_OBJECT ? v->object.len : v->array.len;
+}
+
+static void echo_push_frame(val_t *v) {
+    if (echo_stack_len == echo_stack_capacity) {
+        echo_stack_capacity = echo_stack_capacity == 0 ? ECHO_STACK_INITIAL_CAPACITY : echo_stack_capacity * 2;
+        echo_stack = realloc(echo_stack, echo_stack_capacity * sizeof(echo_frame_t));
     }
 
-    printf(" }");
+    uint64_t len = echo_container_len(v);
+    int64_t limit = echo_items_limit();
+    uint64_t render = (limit > 0 && (uint64_t) limit < len) ? (uint64_t) limit : len;
+
+    echo_stack[echo_stack_len].v = v;
+    echo_stack[echo_stack_len].index = 0;
+    echo_stack[echo_stack_len].render = render;
+    echo_stack_len++;
 }
 
-static void echo_internal(val_t *v) {
+static void echo_scalar(val_t *v) {
     if (v == NULL) {
-        printf("\x1B[2m" "undefined" "\x1B[0m");
+        echo_color("\x1B[2m");
+        echo_cstr("undefined");
+        echo_color("\x1B[0m");
     }
-    else if (v->type == VAL_NULL) {
-        printf("\x1B[1m" "null" "\x1B[0m");
+    else if (val_type_of(v) == VAL_NULL) {
+        echo_color("\x1B[1m");
+        echo_cstr("null");
+        echo_color("\x1B[0m");
     }
-    else if (v->type == VAL_BOOL) {
-        printf("\x1B[0;33m" "%s" "\x1B[0m", v->b ? "true" : "false");
+    else if (val_type_of(v) == VAL_BOOL) {
+        echo_color("\x1B[0;33m");
+        echo_cstr(v->b ? "true" : "false");
+        echo_color("\x1B[0m");
     }
-    else if (v->type == VAL_STR) {
-        printf("\x1B[0;32m" "'%s'" "\x1B[0m", v->str.data);
+    else if (val_type_of(v) == VAL_STR) {
+        echo_color("\x1B[0;32m");
+        echo_cstr("'");
+        echo_write(v->str.data, v->str.len);
+        echo_cstr("'");
+        echo_color("\x1B[0m");
     }
-    else if (v->type == VAL_INT) {
-        printf("\x1B[0;33m" "%lld" "\x1B[0m", v->i64);
+    else if (val_type_of(v) == VAL_INT) {
+        echo_i64(val_as_i64(v));
     }
-    else if (v->type == VAL_FLOAT) {
+    else if (val_type_of(v) == VAL_FLOAT) {
         echo_float(v->f64);
     }
-    else if (v->type == VAL_ARRAY) {
-        echo_array(&v->array);
-    }
-    else if (v->type == VAL_OBJECT) {
-        echo_object(&v->object);
-    }
     else {
-        DEBUG("RUNTIME:: echo: expected, got %d\n", v->type);
+        DEBUG("RUNTIME:: echo: expected, got %d\n", val_type_of(v));
         exit(1);
     }
 }
 
+static void echo_internal(val_t *v) {
+    size_t base = echo_stack_len;
+
+    for (;;) {
+        // Render one value. Containers print their opener and park a
+        // frame; past the depth limit they render as an elided marker.
+        val_type_t type = v == NULL ? VAL_NULL : val_type_of(v);
+        bool is_object = type == VAL_OBJECT;
+        bool is_container = is_object || type == VAL_ARRAY || type == VAL_INT_ARRAY || type == VAL_FLOAT_ARRAY;
+
+        if (!is_container) {
+            echo_scalar(v);
+        } else if (echo_container_len(v) == 0) {
+            echo_cstr(is_object ? "{}" : "[]");
+        } else if (echo_depth_limit() > 0 && (int64_t) (echo_stack_len - base) >= echo_depth_limit()) {
+            echo_cstr(is_object ? "{…}" : "[…]");
+        } else {
+            echo_cstr(is_object ? "{ " : "[ ");
+            echo_push_frame(v);
+        }
+
+        // Advance to the next pending element, closing finished frames.
+        bool have_next = false;
+
+        while (echo_stack_len > base && !have_next) {
+            echo_frame_t *f = &echo_stack[echo_stack_len - 1];
+            val_type_t t = val_type_of(f->v);
+
+            if (f->index < f->render) {
+                if (f->index > 0) {
+                    echo_cstr(", ");
+                }
+
+                if (t == VAL_INT_ARRAY) {
+                    echo_i64(((int64_t *) f->v->array.data)[f->index]);
+                    f->index++;
+                } else if (t == VAL_FLOAT_ARRAY) {
+                    echo_float(((double *) f->v->array.data)[f->index]);
+                    f->index++;
+                } else if (t == VAL_OBJECT) {
+                    echo_cstr(f->v->object.shape->keys[f->index]);
+                    echo_cstr(": ");
+
+                    v = (val_t *) f->v->object.vals[f->index];
+                    f->index++;
+                    have_next = true;
+                } else {
+                    v = (val_t *) f->v->array.data[f->index];
+                    f->index++;
+                    have_next = true;
+                }
+            } else {
+                if (f->render < echo_container_len(f->v)) {
+                    echo_cstr(", …");
+                }
+
+                echo_cstr(t == VAL_OBJECT ? " }" : " ]");
+                echo_stack_len--;
+            }
+        }
+
+        if (!have_next) {
+            return;
+        }
+    }
+}
+
 void *echo(val_t *items) {
-    if (items->type != VAL_ARRAY) {
-        DEBUG("RUNTIME:: echo: expected, got %d\n", items->type);
+    val_type_t type = val_type_of(items);
+
+    if (type != VAL_ARRAY && type != VAL_INT_ARRAY && type != VAL_FLOAT_ARRAY) {
+        DEBUG("RUNTIME:: echo: expected, got %d\n", val_type_of(items));
         exit(1);
     }
 
     for (uint64_t i = 0; i < items->array.len; i++) {
-        val_t *v = (val_t *) items->array.data[i];
-
-        if (v != NULL && v->type == VAL_STR) {
-            printf("%s", v->str.data);
+        if (type == VAL_INT_ARRAY) {
+            echo_i64(((int64_t *) items->array.data)[i]);
+        } else if (type == VAL_FLOAT_ARRAY) {
+            echo_float(((double *) items->array.data)[i]);
         } else {
-            echo_internal(v);
+            val_t *v = (val_t *) items->array.data[i];
+
+            if (v != NULL && val_type_of(v) == VAL_STR) {
+                echo_write(v->str.data, v->str.len);
+            } else {
+                echo_internal(v);
+            }
         }
 
         if (i < items->array.len - 1) {
-            printf(" ");
+            echo_cstr(" ");
         }
     }
 
-    printf("\n");
+    echo_cstr("\n");
+    echo_flush();
 
     free_val_if_ok(items);
 
@@ -0,0 +1,90 @@
+#ifndef MINI_STD_FMT_H
+#define MINI_STD_FMT_H
+
+#include <math.h>
+
+#include "defs.h"
+
+#define FMT_F64_PRECISION 6
+#define FMT_F64_SCALE 1000000ull
+
+// Writes n in decimal, returns the digit count.
+static size_t fmt_u64(char *buf, uint64_t n) {
+    char tmp[20];
+    size_t len = 0;
+
+    do {
+        tmp[len++] = '0' + (char) (n % 10);
+        n /= 10;
+    } while (n > 0);
+
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = tmp[len - 1 - i];
+    }
+
+    return len;
+}
+
+// Formats f like "%.6f" with trailing fraction zeros trimmed (and the
+// point dropped for whole values), generating digits with integer math
+// instead of libc's locale-aware printf machinery. Values that do not
+// fit the fast path (non-finite, |f| >= 2^63) fall back to snprintf,
+// bounded by size; the returned length never exceeds what was written.
+// The fast path itself needs at most 28 bytes (sign, 20 digits, point,
+// 6 fraction digits).
+static size_t fmt_f64(char *buf, size_t size, double f) {
+    size_t len = 0;
+
+    if (!isfinite(f) || f >= 9223372036854775808.0 || f <= -9223372036854775808.0) {
+        int n = snprintf(buf, size, "%.6f", f);
+
+        if (n < 0) {
+            return 0;
+        }
+
+        return (size_t) n < size ? (size_t) n : size - 1;
+    }
+
+    if (f < 0 || (f == 0 && signbit(f))) {
+        buf[len++] = '-';
+        f = -f;
+    }
+
+    uint64_t whole = (uint64_t) f;
+    uint64_t frac = (uint64_t) ((f - (double) whole) * (double) FMT_F64_SCALE + 0.5);
+
+    if (frac >= FMT_F64_SCALE) {
+        whole++;
+        frac = 0;
+    }
+
+    len += fmt_u64(buf + len, whole);
+
+    if (frac > 0) {
+        // The fraction is a 6-digit field: remember how many leading
+        // zeros it carries (1.004 -> frac 4000 -> ".004") before
+        // trimming the trailing ones.
+        int zeros = FMT_F64_PRECISION;
+        for (uint64_t d = frac; d > 0; d /= 10) {
+            zeros--;
+        }
+
+        while (frac % 10 == 0) {
+            frac /= 10;
+        }
+
+        buf[len++] = '.';
+
+        while (zeros-- > 0) {
+            buf[len++] = '0';
+        }
+
+        len += fmt_u64(buf + len, frac);
+    }
+
+    buf[len] = 0;
+
+    return len;
+}
+
+#endif
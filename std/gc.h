@@ -2,59 +2,293 @@
 #define MINI_STD_GC_H
 
 #include "defs.h"
+#include "arena.h"
+#include "cow.h"
+#include "counters.h"
+#include "pool.h"
 
 static int32_t active_val_count = 0;
 
+#ifdef MINI_THREADS
+
+#ifdef MINI_DEFERRED_RC
+#error "MINI_THREADS requires the default immediate refcounting mode"
+#endif
+#ifdef MINI_ARENA
+#error "MINI_THREADS and MINI_ARENA cannot be combined"
+#endif
+
+#endif
+
+#ifndef MINI_ARENA
+
+// Drops one reference without reclaiming; returns true when the value
+// just died and still needs its payload torn down.
+static bool unlink_val_shallow(val_t *val) {
+    if (val != NULL && !val_is_tagged(val) && !val_is_static(val) && val->type != VAL_NULL && val->type != VAL_BOOL) {
+#ifdef MINI_THREADS
+        __atomic_sub_fetch(&active_val_count, 1, __ATOMIC_RELAXED);
+
+        return __atomic_sub_fetch(&val->ref_count, 1, __ATOMIC_ACQ_REL) == 0;
+#else
+        active_val_count--;
+        val->ref_count--;
+
+        assert(val->ref_count >= 0);
+
+        return val->ref_count == 0;
+#endif
+    }
+
+    return false;
+}
+
+// Container teardown is driven by an explicit worklist instead of
+// recursion, so dropping a 10k-deep tree neither overflows the stack
+// nor ping-pongs between levels: each container's pointer array is
+// walked linearly and its dead children are queued. Batches of dead
+// children are freed in address order to keep the pool walks cache
+// friendly.
+#define GC_WORKLIST_INITIAL_CAPACITY 64
+
+static MINI_TLS val_t **gc_worklist = NULL;
+static MINI_TLS size_t gc_worklist_len = 0;
+static MINI_TLS size_t gc_worklist_capacity = 0;
+
+static void gc_worklist_push(val_t *val) {
+    if (gc_worklist_len == gc_worklist_capacity) {
+        gc_worklist_capacity = gc_worklist_capacity == 0 ? GC_WORKLIST_INITIAL_CAPACITY : gc_worklist_capacity * 2;
+        gc_worklist = realloc(gc_worklist, gc_worklist_capacity * sizeof(val_t *));
+    }
+
+    gc_worklist[gc_worklist_len++] = val;
+}
+
+// Descending, so popping from the end of the worklist frees in
+// ascending address order.
+static int gc_addr_compare(const void *a, const void *b) {
+    val_t *va = *(val_t *const *) a;
+    val_t *vb = *(val_t *const *) b;
+
+    return (va < vb) - (va > vb);
+}
+
 static void free_val_if_ok(val_t *val) {
-    if (val != NULL && val->type != VAL_NULL && val->type != VAL_BOOL && val->ref_count == 0) {
-        DEBUG("GC: %p, type: %d", val, val->type);
-
-        if (val->type == VAL_STR) {
-            free_str(&val->str);
-        } else if (val->type == VAL_ARRAY) {
-            for (size_t i = 0; i < val->array.len; i++) {
-                unlink_val(val->array.data[i]);
+    if (val == NULL || val_is_tagged(val) || val->type == VAL_NULL || val->type == VAL_BOOL || val_ref_count(val) != 0) {
+        return;
+    }
+
+    gc_worklist_push(val);
+
+    while (gc_worklist_len > 0) {
+        val_t *v = gc_worklist[--gc_worklist_len];
+        size_t mark = gc_worklist_len;
+
+        DEBUG("GC: %p, type: %d", v, v->type);
+
+        if (v->type == VAL_STR) {
+            free_str(&v->str);
+        } else if (v->type == VAL_ARRAY) {
+            // COW views share one element block; only the last view
+            // standing unlinks the children and frees it (see cow.h).
+            if (v->array.shared == NULL || cow_buf_release(v->array.shared)) {
+                v->array.shared = NULL;
+
+                for (size_t i = 0; i < v->array.len; i++) {
+                    val_t *child = (val_t *) v->array.data[i];
+
+                    if (unlink_val_shallow(child)) {
+                        gc_worklist_push(child);
+                    }
+                }
+
+                free_array(&v->array);
+            }
+        } else if (v->type == VAL_INT_ARRAY || v->type == VAL_FLOAT_ARRAY) {
+            if (v->array.shared == NULL || cow_buf_release(v->array.shared)) {
+                v->array.shared = NULL;
+                free_array(&v->array);
             }
+        } else if (v->type == VAL_OBJECT) {
+            if (v->object.shared == NULL || cow_buf_release(v->object.shared)) {
+                v->object.shared = NULL;
 
-            free_array(&val->array);
-        } else if (val->type == VAL_OBJECT) {
-            for (size_t i = 0; i < val->object.len; i++) {
-                unlink_val(val->object.vals[i]);
+                for (size_t i = 0; i < v->object.len; i++) {
+                    val_t *child = (val_t *) v->object.vals[i];
+
+                    if (unlink_val_shallow(child)) {
+                        gc_worklist_push(child);
+                    }
+                }
+
+                free_object(&v->object);
             }
+        }
 
-            free_array(&val->array);
+        if (gc_worklist_len > mark + 1) {
+            qsort(gc_worklist + mark, gc_worklist_len - mark, sizeof(val_t *), gc_addr_compare);
         }
 
-        free(val);
+        pool_free_val(v);
     }
 }
 
+#endif
+
+#ifdef MINI_ARENA
+
+// Arena mode: nothing is freed per value, so link/unlink shrink to the
+// ref_count bookkeeping the in-place mutation fast paths (ops.h) use as
+// a uniqueness hint, and free_val_if_ok is a no-op. mini_arena_reset
+// releases the whole heap between program invocations; interned keys
+// (intern.h) live in malloc and deliberately survive it.
+
 void link_val(val_t *val) {
-    if (val != NULL && val->type != VAL_NULL && val->type != VAL_BOOL) {
+    COUNT(COUNTER_LINK);
+
+    if (val != NULL && !val_is_tagged(val) && !val_is_static(val) && val->type != VAL_NULL && val->type != VAL_BOOL) {
         active_val_count++;
         val->ref_count++;
+    }
+}
 
-        assert(active_val_count > 0);
-        assert(val->ref_count > 0);
+void unlink_val(val_t *val) {
+    COUNT(COUNTER_UNLINK);
+
+    if (val != NULL && !val_is_tagged(val) && !val_is_static(val) && val->type != VAL_NULL && val->type != VAL_BOOL) {
+        active_val_count--;
+        val->ref_count--;
+    }
+}
+
+static void free_val_if_ok(val_t *val) {
+    (void) val;
+}
+
+void mini_arena_reset() {
+    while (arena_chunks != NULL) {
+        arena_chunk_t *next = arena_chunks->next;
+        free(arena_chunks);
+        arena_chunks = next;
+    }
+
+    while (pool_chunks != NULL) {
+        pool_chunk_t *next = pool_chunks->next;
+        free(pool_chunks);
+        pool_chunks = next;
+    }
+
+    pool_free_list = NULL;
+    pool_bump = POOL_CHUNK_SLOTS;
+
+    // The string free lists point into released chunks.
+    for (int i = 0; i < STR_BUF_CLASSES; i++) {
+        str_buf_free_lists[i] = NULL;
+    }
+
+    active_val_count = 0;
+}
+
+#elif defined(MINI_DEFERRED_RC)
+
+// Deferred mode: an unlink that drops a value to zero parks it on the
+// pending buffer (ref_count = RC_PENDING) instead of freeing, and a
+// later link resurrects it — so hot-loop link/unlink pairs that cancel
+// out never touch the allocator. mini_rc_settle drains the survivors at
+// safe points; it also runs automatically when the buffer fills. The
+// immediate mode below stays the default build for debugging.
+
+#define RC_PENDING (-2)
+#define RC_PENDING_BUF_SIZE 256
+
+static val_t *rc_pending_vals[RC_PENDING_BUF_SIZE];
+static size_t rc_pending_len = 0;
+
+void mini_rc_settle() {
+    while (rc_pending_len > 0) {
+        val_t *val = rc_pending_vals[--rc_pending_len];
+
+        if (val->ref_count == RC_PENDING) {
+            val->ref_count = 0;
+            free_val_if_ok(val);
+        }
+    }
+}
+
+void link_val(val_t *val) {
+    COUNT(COUNTER_LINK);
+
+    if (val != NULL && !val_is_tagged(val) && !val_is_static(val) && val->type != VAL_NULL && val->type != VAL_BOOL) {
+        active_val_count++;
+
+        if (val->ref_count == RC_PENDING) {
+            val->ref_count = 1;
+
+            DEBUG("link (resurrect): %p, type: %d, active: %d", val, val->type, active_val_count);
+
+            return;
+        }
+
+        val->ref_count++;
 
         DEBUG("link: %p, type: %d, active: %d", val, val->type, active_val_count);
     }
 }
 
 void unlink_val(val_t *val) {
-    if (val != NULL && val->type != VAL_NULL && val->type != VAL_BOOL) {
+    COUNT(COUNTER_UNLINK);
+
+    if (val != NULL && !val_is_tagged(val) && !val_is_static(val) && val->type != VAL_NULL && val->type != VAL_BOOL) {
         active_val_count--;
         val->ref_count--;
 
-        assert(active_val_count >= 0);
         assert(val->ref_count >= 0);
 
         if (val->ref_count == 0) {
-            free_val_if_ok(val);
+            val->ref_count = RC_PENDING;
+
+            if (rc_pending_len == RC_PENDING_BUF_SIZE) {
+                mini_rc_settle();
+            }
+
+            rc_pending_vals[rc_pending_len++] = val;
         }
 
         DEBUG("unlink: %p, type: %d, active: %d", val, val->type, active_val_count);
     }
 }
 
+#else
+
+void link_val(val_t *val) {
+    COUNT(COUNTER_LINK);
+
+    if (val != NULL && !val_is_tagged(val) && !val_is_static(val) && val->type != VAL_NULL && val->type != VAL_BOOL) {
+#ifdef MINI_THREADS
+        __atomic_add_fetch(&active_val_count, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&val->ref_count, 1, __ATOMIC_ACQ_REL);
+#else
+        active_val_count++;
+        val->ref_count++;
+
+        assert(active_val_count > 0);
+        assert(val->ref_count > 0);
+#endif
+
+        DEBUG("link: %p, type: %d, active: %d", val, val->type, active_val_count);
+    }
+}
+
+void unlink_val(val_t *val) {
+    COUNT(COUNTER_UNLINK);
+
+    if (unlink_val_shallow(val)) {
+        free_val_if_ok(val);
+    }
+
+    DEBUG("unlink: %p, active: %d", val, active_val_count);
+}
+
+#endif
+
 #endif
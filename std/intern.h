@@ -0,0 +1,109 @@
+#ifndef MINI_STD_INTERN_H
+#define MINI_STD_INTERN_H
+
+#include "defs.h"
+
+// The intern table and the shape transition edges (object.h) are shared
+// immortal structures; under MINI_THREADS one coarse mutex guards their
+// mutation. Both are read-mostly once the key set has warmed up.
+#ifdef MINI_THREADS
+#include <pthread.h>
+
+static pthread_mutex_t mini_shared_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#define MINI_SHARED_LOCK() pthread_mutex_lock(&mini_shared_mutex)
+#define MINI_SHARED_UNLOCK() pthread_mutex_unlock(&mini_shared_mutex)
+#else
+#define MINI_SHARED_LOCK()
+#define MINI_SHARED_UNLOCK()
+#endif
+
+#define INTERN_INITIAL_CAPACITY 256
+
+typedef struct {
+    uint32_t hash;
+    char *key;
+} intern_entry_t;
+
+static intern_entry_t *intern_entries = NULL;
+static size_t intern_capacity = 0;
+static size_t intern_len = 0;
+
+// FNV-1a over the key bytes; paid once per distinct string, after which
+// lookups compare interned pointers.
+static uint32_t intern_key_hash(const char *k) {
+    uint32_t hash = 2166136261u;
+
+    while (*k) {
+        hash ^= (uint8_t) *k++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static void intern_grow() {
+    intern_entry_t *old_entries = intern_entries;
+    size_t old_capacity = intern_capacity;
+
+    intern_capacity = (intern_capacity == 0) ? INTERN_INITIAL_CAPACITY : intern_capacity * 2;
+    intern_entries = calloc(intern_capacity, sizeof(intern_entry_t));
+
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_entries[i].key == NULL) {
+            continue;
+        }
+
+        size_t j = old_entries[i].hash & (intern_capacity - 1);
+        while (intern_entries[j].key != NULL) {
+            j = (j + 1) & (intern_capacity - 1);
+        }
+
+        intern_entries[j] = old_entries[i];
+    }
+
+    free(old_entries);
+}
+
+// Returns the canonical pointer for this key, interning it on first use.
+// Interned keys live for the whole run; the precomputed hash comes back
+// through hash_out so callers never hash a canonical key twice.
+static char *intern_key(char *k, uint32_t *hash_out) {
+    MINI_SHARED_LOCK();
+
+    if (intern_len * 4 >= intern_capacity * 3) {
+        intern_grow();
+    }
+
+    uint32_t hash = intern_key_hash(k);
+    size_t mask = intern_capacity - 1;
+    size_t i = hash & mask;
+
+    for (;;) {
+        intern_entry_t *entry = &intern_entries[i];
+
+        if (entry->key == NULL) {
+            size_t len = strlen(k);
+            char *copy = malloc(len + 1);
+            memcpy(copy, k, len + 1);
+
+            entry->hash = hash;
+            entry->key = copy;
+            intern_len++;
+
+            *hash_out = hash;
+            MINI_SHARED_UNLOCK();
+            return copy;
+        }
+
+        if (entry->hash == hash && (entry->key == k || strcmp(entry->key, k) == 0)) {
+            *hash_out = entry->hash;
+            MINI_SHARED_UNLOCK();
+            return entry->key;
+        }
+
+        i = (i + 1) & mask;
+    }
+}
+
+#endif
@@ -2,45 +2,197 @@
 #define MINI_STD_OBJECT_H
 
 #include "defs.h"
+#include "arena.h"
+#include "cow.h"
+#include "intern.h"
+#include "stats.h"
 
 void link_val(val_t *val);
 void unlink_val(val_t *val);
 
+#define OBJECT_SLOT_EMPTY UINT32_MAX
+#define OBJECT_INDEX_INITIAL_CAPACITY 8
+
+// A shape (hidden class) describes one key insertion order: the keys in
+// slot order, an open-addressing index over them, and transition edges
+// to the shapes reached by adding one more key. Every object built with
+// the same insertion order points at the same shape, so per-record cost
+// is the vals slots plus one pointer. Shapes are immortal, like
+// interned keys, and survive arena resets.
+struct object_shape {
+    uint32_t len;
+    uint32_t index_capacity;
+    char **keys;
+    object_slot_t *index;
+    char **transition_keys;
+    struct object_shape **transition_shapes;
+    uint32_t transitions_len;
+    uint32_t transitions_capacity;
+};
+
+static object_shape_t object_shape_root;
+
 static void free_object(object_t *kv) {
-    free(kv->keys);
-    free(kv->vals);
+    mini_free(kv->vals);
 }
 
-static void new_object(object_t *result) {
-    char **keys = malloc(sizeof(char *));
-    void **vals = malloc(sizeof(void *));
+static object_slot_t *object_new_index(size_t index_capacity) {
+    object_slot_t *index = malloc(index_capacity * sizeof(object_slot_t));
+
+    for (size_t i = 0; i < index_capacity; i++) {
+        index[i].entry = OBJECT_SLOT_EMPTY;
+    }
+
+    return index;
+}
+
+// Finds the slot holding this key in the shape, or OBJECT_SLOT_EMPTY.
+// Stored keys are interned, so matching is a pointer compare.
+static uint32_t shape_find(object_shape_t *shape, char *k, uint32_t hash) {
+    if (shape->len == 0) {
+        return OBJECT_SLOT_EMPTY;
+    }
+
+    size_t mask = shape->index_capacity - 1;
+    size_t i = hash & mask;
+
+    for (;;) {
+        object_slot_t *slot = &shape->index[i];
+
+        if (slot->entry == OBJECT_SLOT_EMPTY) {
+            return OBJECT_SLOT_EMPTY;
+        }
+
+        if (slot->hash == hash && shape->keys[slot->entry] == k) {
+            return slot->entry;
+        }
+
+        i = (i + 1) & mask;
+    }
+}
+
+// Returns the shape reached by adding k to this one, creating it on
+// first use. Later objects built with the same insertion order take the
+// cached edge and share everything.
+static object_shape_t *shape_transition(object_shape_t *shape, char *k) {
+    MINI_SHARED_LOCK();
+
+    for (uint32_t i = 0; i < shape->transitions_len; i++) {
+        if (shape->transition_keys[i] == k) {
+            MINI_SHARED_UNLOCK();
+            return shape->transition_shapes[i];
+        }
+    }
+
+    object_shape_t *child = malloc(sizeof(object_shape_t));
+
+    child->len = shape->len + 1;
+    child->keys = malloc(child->len * sizeof(char *));
+    memcpy(child->keys, shape->keys, shape->len * sizeof(char *));
+    child->keys[shape->len] = k;
+
+    child->index_capacity = OBJECT_INDEX_INITIAL_CAPACITY;
+    while (child->len * 4 > child->index_capacity * 3) {
+        child->index_capacity *= 2;
+    }
+    child->index = object_new_index(child->index_capacity);
+
+    for (uint32_t e = 0; e < child->len; e++) {
+        // The keys are already canonical; hash directly instead of going
+        // back through intern_key (which takes the shared lock).
+        uint32_t hash = intern_key_hash(child->keys[e]);
+
+        size_t mask = child->index_capacity - 1;
+        size_t i = hash & mask;
 
+        while (child->index[i].entry != OBJECT_SLOT_EMPTY) {
+            i = (i + 1) & mask;
+        }
+
+        child->index[i].hash = hash;
+        child->index[i].entry = e;
+    }
+
+    child->transition_keys = NULL;
+    child->transition_shapes = NULL;
+    child->transitions_len = 0;
+    child->transitions_capacity = 0;
+
+    if (shape->transitions_len == shape->transitions_capacity) {
+        shape->transitions_capacity = shape->transitions_capacity == 0 ? 4 : shape->transitions_capacity * 2;
+        shape->transition_keys = realloc(shape->transition_keys, shape->transitions_capacity * sizeof(char *));
+        shape->transition_shapes = realloc(shape->transition_shapes, shape->transitions_capacity * sizeof(object_shape_t *));
+    }
+
+    shape->transition_keys[shape->transitions_len] = k;
+    shape->transition_shapes[shape->transitions_len] = child;
+    shape->transitions_len++;
+
+    STATS_ADD(stats_object_bytes, sizeof(object_shape_t) + child->len * sizeof(char *)
+        + child->index_capacity * sizeof(object_slot_t));
+
+    DEBUG("SHAPE: new: %p, len: %u, key: %s", child, child->len, k);
+
+    MINI_SHARED_UNLOCK();
+    return child;
+}
+
+static void new_object(object_t *result) {
+    result->shape = &object_shape_root;
     result->capacity = 1;
     result->len = 0;
-    result->keys = keys;
-    result->vals = vals;
+    result->vals = mini_alloc(sizeof(void *));
+    result->shared = NULL;
+
+    STATS_ADD(stats_object_bytes, sizeof(void *));
 }
 
-static void object_set(object_t *result, char *k, void *v) {
+// Sets k to v, keeping the key's original insertion position. Returns
+// the replaced value when the key already existed (the caller owns
+// unlinking it), NULL on a fresh insert — so accumulator objects stay at
+// their true size instead of growing with every update.
+static void *object_set(object_t *result, char *k, void *v) {
+    // Shared vals blocks are read-only; callers unshare before writing.
+    assert(result->shared == NULL);
+
+    uint32_t hash;
+    k = intern_key(k, &hash);
+
+    uint32_t slot = shape_find(result->shape, k, hash);
+
+    if (slot != OBJECT_SLOT_EMPTY) {
+        void *old = result->vals[slot];
+        result->vals[slot] = v;
+
+        return old;
+    }
+
+    result->shape = shape_transition(result->shape, k);
+
     if (result->len == result->capacity) {
-        result->capacity *= 2;
-        result->keys = realloc(result->keys, result->capacity * sizeof(void *));
-        result->vals = realloc(result->vals, result->capacity * sizeof(void *));
+        size_t capacity = result->capacity * 2;
+
+        result->vals = mini_realloc(result->vals, result->capacity * sizeof(void *), capacity * sizeof(void *));
+        result->capacity = capacity;
     }
 
-    result->keys[result->len] = k;
     result->vals[result->len] = v;
     result->len++;
+
+    return NULL;
 }
 
 static void *object_get(object_t *result, char *k) {
-    for (size_t i = 0; i < result->len; i++) {
-        if (strcmp(result->keys[i], k) == 0) {
-            return result->vals[i];
-        }
+    uint32_t hash;
+    k = intern_key(k, &hash);
+
+    uint32_t slot = shape_find(result->shape, k, hash);
+
+    if (slot == OBJECT_SLOT_EMPTY) {
+        return NULL;
     }
 
-    return NULL;
+    return result->vals[slot];
 }
 
 
@@ -9,37 +9,91 @@
 #include <string.h>
 
 #include "defs.h"
+#include "counters.h"
 #include "str.h"
 #include "array.h"
 #include "object.h"
 #include "gc.h"
+#include "simd.h"
 
 static val_t *new_str_with_combine(val_t *v1, val_t *v2) {
+    // An exclusively-owned temporary on the left is about to die anyway:
+    // append into its buffer instead of copying both sides.
+    if (!val_is_static(v1) && val_ref_count(v1) == 0) {
+        str_append(&v1->str, &v2->str);
+
+        DEBUG("str append: %s, %p", v1->str.data, v1);
+
+        free_val_if_ok(v2);
+
+        return v1;
+    }
+
     val_t *result = new_val(VAL_STR);
     str_combine(&result->str, &v1->str, &v2->str);
 
     DEBUG("new str with combine: %s, %p", result->str.data, result);
 
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return result;
+}
+
+val_t *val_str_substring(val_t *s, val_t *start, val_t *end) {
+    if (val_type_of(s) != VAL_STR) {
+        assert(false);
+    }
+
+    int64_t from = val_as_i64(start);
+    int64_t to = val_as_i64(end);
+
+    if (from < 0) {
+        from = 0;
+    }
+    if (to > (int64_t) s->str.len) {
+        to = (int64_t) s->str.len;
+    }
+    if (from > to) {
+        from = to;
+    }
+
+    val_t *result = new_val(VAL_STR);
+
+    if (val_is_static(s)) {
+        str_slice_copy(&result->str, &s->str, (uint64_t) from, (uint64_t) (to - from));
+    } else {
+        str_slice(&result->str, &s->str, (uint64_t) from, (uint64_t) (to - from));
+    }
+
+    DEBUG("new str slice: %lld..%lld, %p", from, to, result);
+
+    free_val_if_ok(start);
+    free_val_if_ok(end);
+    free_val_if_ok(s);
+
     return result;
 }
 
 val_t *val_op_add(val_t *v1, val_t *v2) {
+    COUNT_PAIR(val_type_of(v1), val_type_of(v2));
+
     val_t *result = NULL;
 
-    if (v1->type == VAL_STR && v2->type == VAL_STR) {
-        result = new_str_with_combine(v1, v2);
+    if (val_type_of(v1) == VAL_STR && val_type_of(v2) == VAL_STR) {
+        return new_str_with_combine(v1, v2);
     }
-    else if (v1->type == VAL_FLOAT && v2->type == VAL_FLOAT) {
+    else if (val_type_of(v1) == VAL_FLOAT && val_type_of(v2) == VAL_FLOAT) {
         result = new_float_val(v1->f64 + v2->f64);
     }
-    else if (v1->type == VAL_INT && v2->type == VAL_FLOAT) {
-        result = new_float_val((float) v1->i64 + v2->f64);
+    else if (val_type_of(v1) == VAL_INT && val_type_of(v2) == VAL_FLOAT) {
+        result = new_float_val((float) val_as_i64(v1) + v2->f64);
     }
-    else if (v1->type == VAL_FLOAT && v2->type == VAL_INT) {
-        result = new_float_val(v1->f64 + (float) v2->i64);
+    else if (val_type_of(v1) == VAL_FLOAT && val_type_of(v2) == VAL_INT) {
+        result = new_float_val(v1->f64 + (float) val_as_i64(v2));
     }
-    else if (v1->type == VAL_INT && v2->type == VAL_INT) {
-        result = new_int_val(v1->i64 + v2->i64);
+    else if (val_type_of(v1) == VAL_INT && val_type_of(v2) == VAL_INT) {
+        result = new_int_val(val_as_i64(v1) + val_as_i64(v2));
     }
     else {
         assert(false);
@@ -53,19 +107,21 @@ val_t *val_op_add(val_t *v1, val_t *v2) {
 
 
 val_t *val_op_sub(val_t *v1, val_t *v2) {
+    COUNT_PAIR(val_type_of(v1), val_type_of(v2));
+
     val_t *result = NULL;
 
-    if (v1->type == VAL_FLOAT && v2->type == VAL_FLOAT) {
+    if (val_type_of(v1) == VAL_FLOAT && val_type_of(v2) == VAL_FLOAT) {
         result = new_float_val(v1->f64 - v2->f64);
     }
-    else if (v1->type == VAL_INT && v2->type == VAL_FLOAT) {
-        result = new_float_val((float) v1->i64 - v2->f64);
+    else if (val_type_of(v1) == VAL_INT && val_type_of(v2) == VAL_FLOAT) {
+        result = new_float_val((float) val_as_i64(v1) - v2->f64);
     }
-    else if (v1->type == VAL_FLOAT && v2->type == VAL_INT) {
-        result = new_float_val(v1->f64 - (float) v2->i64);
+    else if (val_type_of(v1) == VAL_FLOAT && val_type_of(v2) == VAL_INT) {
+        result = new_float_val(v1->f64 - (float) val_as_i64(v2));
     }
-    else if (v1->type == VAL_INT && v2->type == VAL_INT) {
-        result = new_int_val(v1->i64 - v2->i64);
+    else if (val_type_of(v1) == VAL_INT && val_type_of(v2) == VAL_INT) {
+        result = new_int_val(val_as_i64(v1) - val_as_i64(v2));
     }
     else {
         assert(false);
@@ -78,19 +134,21 @@ val_t *val_op_sub(val_t *v1, val_t *v2) {
 }
 
 val_t *val_op_mul(val_t *v1, val_t *v2) {
+    COUNT_PAIR(val_type_of(v1), val_type_of(v2));
+
     val_t *result = NULL;
 
-    if (v1->type == VAL_FLOAT && v2->type == VAL_FLOAT) {
+    if (val_type_of(v1) == VAL_FLOAT && val_type_of(v2) == VAL_FLOAT) {
         result = new_float_val(v1->f64 * v2->f64);
     }
-    else if (v1->type == VAL_INT && v2->type == VAL_FLOAT) {
-        result = new_float_val((float) v1->i64 * v2->f64);
+    else if (val_type_of(v1) == VAL_INT && val_type_of(v2) == VAL_FLOAT) {
+        result = new_float_val((float) val_as_i64(v1) * v2->f64);
     }
-    else if (v1->type == VAL_FLOAT && v2->type == VAL_INT) {
-        result = new_float_val(v1->f64 * (float) v2->i64);
+    else if (val_type_of(v1) == VAL_FLOAT && val_type_of(v2) == VAL_INT) {
+        result = new_float_val(v1->f64 * (float) val_as_i64(v2));
     }
-    else if (v1->type == VAL_INT && v2->type == VAL_INT) {
-        result = new_int_val(v1->i64 * v2->i64);
+    else if (val_type_of(v1) == VAL_INT && val_type_of(v2) == VAL_INT) {
+        result = new_int_val(val_as_i64(v1) * val_as_i64(v2));
     }
     else {
         assert(false);
@@ -103,19 +161,21 @@ val_t *val_op_mul(val_t *v1, val_t *v2) {
 }
 
 val_t *val_op_div(val_t *v1, val_t *v2) {
+    COUNT_PAIR(val_type_of(v1), val_type_of(v2));
+
     val_t *result = NULL;
 
-    if (v1->type == VAL_FLOAT && v2->type == VAL_FLOAT) {
+    if (val_type_of(v1) == VAL_FLOAT && val_type_of(v2) == VAL_FLOAT) {
         result = new_float_val(v1->f64 / v2->f64);
     }
-    else if (v1->type == VAL_INT && v2->type == VAL_FLOAT) {
-        result = new_float_val((float) v1->i64 / v2->f64);
+    else if (val_type_of(v1) == VAL_INT && val_type_of(v2) == VAL_FLOAT) {
+        result = new_float_val((float) val_as_i64(v1) / v2->f64);
     }
-    else if (v1->type == VAL_FLOAT && v2->type == VAL_INT) {
-        result = new_float_val(v1->f64 / (float) v2->i64);
+    else if (val_type_of(v1) == VAL_FLOAT && val_type_of(v2) == VAL_INT) {
+        result = new_float_val(v1->f64 / (float) val_as_i64(v2));
     }
-    else if (v1->type == VAL_INT && v2->type == VAL_INT) {
-        result = new_float_val((float) v1->i64 / (float) v2->i64);
+    else if (val_type_of(v1) == VAL_INT && val_type_of(v2) == VAL_INT) {
+        result = new_float_val((float) val_as_i64(v1) / (float) val_as_i64(v2));
     }
     else {
         assert(false);
@@ -129,10 +189,12 @@ val_t *val_op_div(val_t *v1, val_t *v2) {
 
 
 val_t *val_op_mod(val_t *v1, val_t *v2) {
+    COUNT_PAIR(val_type_of(v1), val_type_of(v2));
+
     val_t *result = NULL;
 
-    if (v1->type == VAL_INT && v2->type == VAL_INT) {
-        result = new_int_val(v1->i64 % v2->i64);
+    if (val_type_of(v1) == VAL_INT && val_type_of(v2) == VAL_INT) {
+        result = new_int_val(val_as_i64(v1) % val_as_i64(v2));
     }
     else {
         assert(false);
@@ -145,18 +207,208 @@ val_t *val_op_mod(val_t *v1, val_t *v2) {
 }
 
 
+// Monomorphic entry points for the code generator: when --optimize has
+// proven both operand types it calls these instead of the generic ops,
+// skipping the dispatch chain. Operand release is kept (boxed operands
+// still need it) but costs a single early-out branch for immediates.
+
+val_t *val_op_add_int_int(val_t *v1, val_t *v2) {
+    val_t *result = new_int_val(val_as_i64(v1) + val_as_i64(v2));
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return result;
+}
+
+val_t *val_op_sub_int_int(val_t *v1, val_t *v2) {
+    val_t *result = new_int_val(val_as_i64(v1) - val_as_i64(v2));
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return result;
+}
+
+val_t *val_op_mul_int_int(val_t *v1, val_t *v2) {
+    val_t *result = new_int_val(val_as_i64(v1) * val_as_i64(v2));
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return result;
+}
+
+val_t *val_op_mod_int_int(val_t *v1, val_t *v2) {
+    val_t *result = new_int_val(val_as_i64(v1) % val_as_i64(v2));
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return result;
+}
+
+val_t *val_op_add_f64_f64(val_t *v1, val_t *v2) {
+    val_t *result = new_float_val(v1->f64 + v2->f64);
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return result;
+}
+
+val_t *val_op_sub_f64_f64(val_t *v1, val_t *v2) {
+    val_t *result = new_float_val(v1->f64 - v2->f64);
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return result;
+}
+
+val_t *val_op_mul_f64_f64(val_t *v1, val_t *v2) {
+    val_t *result = new_float_val(v1->f64 * v2->f64);
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return result;
+}
+
+val_t *val_op_div_f64_f64(val_t *v1, val_t *v2) {
+    val_t *result = new_float_val(v1->f64 / v2->f64);
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return result;
+}
+
+// Caller-provided result storage for --optimize: the out slot lives in
+// the generated stack frame, marked static so the RC machinery never
+// links or frees it. Only the float ops need these — tagged ints never
+// allocate in the first place. The temporary must not escape its frame;
+// the generator only emits them for operands consumed immediately.
+val_t *val_op_add_f64_f64_into(val_t *out, val_t *v1, val_t *v2) {
+    out->type = VAL_FLOAT;
+    out->ref_count = VAL_STATIC_REF;
+    out->f64 = v1->f64 + v2->f64;
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return out;
+}
+
+val_t *val_op_sub_f64_f64_into(val_t *out, val_t *v1, val_t *v2) {
+    out->type = VAL_FLOAT;
+    out->ref_count = VAL_STATIC_REF;
+    out->f64 = v1->f64 - v2->f64;
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return out;
+}
+
+val_t *val_op_mul_f64_f64_into(val_t *out, val_t *v1, val_t *v2) {
+    out->type = VAL_FLOAT;
+    out->ref_count = VAL_STATIC_REF;
+    out->f64 = v1->f64 * v2->f64;
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return out;
+}
+
+val_t *val_op_div_f64_f64_into(val_t *out, val_t *v1, val_t *v2) {
+    out->type = VAL_FLOAT;
+    out->ref_count = VAL_STATIC_REF;
+    out->f64 = v1->f64 / v2->f64;
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return out;
+}
+
+val_t *val_op_lt_int_int(val_t *v1, val_t *v2) {
+    bool result = val_as_i64(v1) < val_as_i64(v2);
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return new_bool_val(result);
+}
+
+val_t *val_op_lte_int_int(val_t *v1, val_t *v2) {
+    bool result = val_as_i64(v1) <= val_as_i64(v2);
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return new_bool_val(result);
+}
+
+val_t *val_op_gt_int_int(val_t *v1, val_t *v2) {
+    bool result = val_as_i64(v1) > val_as_i64(v2);
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return new_bool_val(result);
+}
+
+val_t *val_op_gte_int_int(val_t *v1, val_t *v2) {
+    bool result = val_as_i64(v1) >= val_as_i64(v2);
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return new_bool_val(result);
+}
+
+val_t *val_op_eq_int_int(val_t *v1, val_t *v2) {
+    bool result = val_as_i64(v1) == val_as_i64(v2);
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return new_bool_val(result);
+}
+
+val_t *val_op_neq_int_int(val_t *v1, val_t *v2) {
+    bool result = val_as_i64(v1) != val_as_i64(v2);
+
+    free_val_if_ok(v1);
+    free_val_if_ok(v2);
+
+    return new_bool_val(result);
+}
+
 short val_compare(val_t *v1, val_t *v2) {
-    if (v1->type == VAL_FLOAT && v2->type == VAL_FLOAT) {
+    if (val_type_of(v1) == VAL_FLOAT && val_type_of(v2) == VAL_FLOAT) {
         return (v1->f64 < v2->f64) ? -1 : ((v1->f64 > v2->f64) ? 1 : 0);
     }
-    else if (v1->type == VAL_INT && v2->type == VAL_FLOAT) {
-        return ((float) v1->i64 < v2->f64) ? -1 : (((float) v1->i64 > v2->f64) ? 1 : 0);
+    else if (val_type_of(v1) == VAL_INT && val_type_of(v2) == VAL_FLOAT) {
+        return ((float) val_as_i64(v1) < v2->f64) ? -1 : (((float) val_as_i64(v1) > v2->f64) ? 1 : 0);
+    }
+    else if (val_type_of(v1) == VAL_FLOAT && val_type_of(v2) == VAL_INT) {
+        return (v1->f64 < (float) val_as_i64(v2)) ? -1 : ((v1->f64 > (float) val_as_i64(v2)) ? 1 : 0);
     }
-    else if (v1->type == VAL_FLOAT && v2->type == VAL_INT) {
-        return (v1->f64 < (float) v2->i64) ? -1 : ((v1->f64 > (float) v2->i64) ? 1 : 0);
+    else if (val_type_of(v1) == VAL_INT && val_type_of(v2) == VAL_INT) {
+        return (val_as_i64(v1) < val_as_i64(v2)) ? -1 : ((val_as_i64(v1) > val_as_i64(v2)) ? 1 : 0);
     }
-    else if (v1->type == VAL_INT && v2->type == VAL_INT) {
-        return (v1->i64 < v2->i64) ? -1 : ((v1->i64 > v2->i64) ? 1 : 0);
+    else if (val_type_of(v1) == VAL_STR && val_type_of(v2) == VAL_STR) {
+        size_t n = v1->str.len < v2->str.len ? v1->str.len : v2->str.len;
+        int c = memcmp(v1->str.data, v2->str.data, n);
+
+        if (c != 0) {
+            return c < 0 ? -1 : 1;
+        }
+
+        return (v1->str.len < v2->str.len) ? -1 : ((v1->str.len > v2->str.len) ? 1 : 0);
     }
 
     assert(false);
@@ -164,6 +416,18 @@ short val_compare(val_t *v1, val_t *v2) {
 }
 
 void *val_op_eq(val_t *v1, val_t *v2) {
+    // Equality does not need an ordering: the string path goes through
+    // str_eq, whose cached length/hash checks reject most mismatches
+    // without touching the bytes.
+    if (val_type_of(v1) == VAL_STR && val_type_of(v2) == VAL_STR) {
+        bool eq = str_eq(&v1->str, &v2->str);
+
+        free_val_if_ok(v1);
+        free_val_if_ok(v2);
+
+        return new_bool_val(eq);
+    }
+
     short status = val_compare(v1, v2);
 
     free_val_if_ok(v1);
@@ -173,6 +437,15 @@ void *val_op_eq(val_t *v1, val_t *v2) {
 }
 
 void *val_op_neq(val_t *v1, val_t *v2) {
+    if (val_type_of(v1) == VAL_STR && val_type_of(v2) == VAL_STR) {
+        bool eq = str_eq(&v1->str, &v2->str);
+
+        free_val_if_ok(v1);
+        free_val_if_ok(v2);
+
+        return new_bool_val(!eq);
+    }
+
     short status = val_compare(v1, v2);
 
     free_val_if_ok(v1);
@@ -186,10 +459,19 @@ void *val_op_seq(val_t *v1, val_t *v2) {
         return new_bool_val(v1 == v2);
     }
 
-    if (v1->type != v2->type) {
+    if (val_type_of(v1) != val_type_of(v2)) {
         return new_bool_val(false);
     }
 
+    if (val_type_of(v1) == VAL_STR) {
+        bool eq = str_eq(&v1->str, &v2->str);
+
+        free_val_if_ok(v1);
+        free_val_if_ok(v2);
+
+        return new_bool_val(eq);
+    }
+
     short status = val_compare(v1, v2);
 
     free_val_if_ok(v1);
@@ -203,10 +485,19 @@ void *val_op_sneq(val_t *v1, val_t *v2) {
         return new_bool_val(v1 == v2);
     }
 
-    if (v1->type != v2->type) {
+    if (val_type_of(v1) != val_type_of(v2)) {
         return new_bool_val(false);
     }
 
+    if (val_type_of(v1) == VAL_STR) {
+        bool eq = str_eq(&v1->str, &v2->str);
+
+        free_val_if_ok(v1);
+        free_val_if_ok(v2);
+
+        return new_bool_val(!eq);
+    }
+
     short status = val_compare(v1, v2);
 
     free_val_if_ok(v1);
@@ -252,7 +543,7 @@ void *val_op_gte(val_t *v1, val_t *v2) {
 }
 
 void *val_op_and(val_t *v1, val_t *v2) {
-    if (v1->type != VAL_BOOL || v2->type != VAL_BOOL) {
+    if (val_type_of(v1) != VAL_BOOL || val_type_of(v2) != VAL_BOOL) {
         assert(false);
     }
 
@@ -265,7 +556,7 @@ void *val_op_and(val_t *v1, val_t *v2) {
 }
 
 void *val_op_or(val_t *v1, val_t *v2) {
-    if (v1->type != VAL_BOOL || v2->type != VAL_BOOL) {
+    if (val_type_of(v1) != VAL_BOOL || val_type_of(v2) != VAL_BOOL) {
         assert(false);
     }
 
@@ -278,7 +569,7 @@ void *val_op_or(val_t *v1, val_t *v2) {
 }
 
 void *val_op_not(val_t *v) {
-    if (v->type != VAL_BOOL) {
+    if (val_type_of(v) != VAL_BOOL) {
         assert(false);
     }
 
@@ -290,13 +581,13 @@ void *val_op_not(val_t *v) {
 }
 
 void *val_op_pos(val_t *v) {
-    if (v->type == VAL_INT || v->type == VAL_FLOAT) {
+    if (val_type_of(v) == VAL_INT || val_type_of(v) == VAL_FLOAT) {
         return v;
     }
 
     val_t *result;
 
-    if (v->type == VAL_BOOL) {
+    if (val_type_of(v) == VAL_BOOL) {
         result = new_int_val(v->b ? 1 : 0);
     } else {
         assert(false);
@@ -310,9 +601,9 @@ void *val_op_pos(val_t *v) {
 void *val_op_neg(val_t *v) {
     val_t *result;
 
-    if (v->type == VAL_INT) {
-        return new_int_val(-v->i64);
-    } else if (v->type == VAL_FLOAT) {
+    if (val_type_of(v) == VAL_INT) {
+        return new_int_val(-val_as_i64(v));
+    } else if (val_type_of(v) == VAL_FLOAT) {
         return new_float_val(-v->f64);
     } else {
         assert(false);
@@ -323,8 +614,101 @@ void *val_op_neg(val_t *v) {
     return result;
 }
 
+// Boxes every element of an unboxed array in place and switches it to
+// the boxed representation. Int elements become tagged immediates, so
+// only float arrays actually allocate here.
+// Duplicates a COW-shared data block before a mutation. If this was the
+// last view left, the block simply becomes exclusively owned again.
+// Boxed elements gain one reference for the new block, matching the
+// per-block accounting in gc.h.
+static void val_array_unshare(val_t *items) {
+    cow_buf_t *shared = items->array.shared;
+
+    if (shared == NULL) {
+        return;
+    }
+
+    if (cow_buf_release(shared)) {
+        items->array.shared = NULL;
+
+        return;
+    }
+
+    array_t *a = &items->array;
+    void **data = mini_alloc(a->capacity * sizeof(void *));
+
+    STATS_ADD(stats_array_bytes, a->capacity * sizeof(void *));
+
+    memcpy(data, a->data, a->len * sizeof(void *));
+
+    a->data = data;
+    a->shared = NULL;
+
+    if (val_type_of(items) == VAL_ARRAY) {
+        for (size_t i = 0; i < a->len; i++) {
+            link_val((val_t *) a->data[i]);
+        }
+    }
+
+    DEBUG("ARRAY: unshare: %p, len: %zu", items, a->len);
+}
+
+static void val_array_unbox(val_t *items) {
+    val_array_unshare(items);
+
+    array_t *a = &items->array;
+
+    for (size_t i = 0; i < a->len; i++) {
+        val_t *e;
+
+        if (items->type == VAL_INT_ARRAY) {
+            e = new_int_val(((int64_t *) a->data)[i]);
+        } else {
+            e = new_float_val(((double *) a->data)[i]);
+        }
+
+        a->data[i] = e;
+        link_val(e);
+    }
+
+    DEBUG("ARRAY: unbox: %p, len: %zu", items, a->len);
+
+    val_retype(items, VAL_ARRAY);
+}
+
 void *val_array_push(val_t *items, val_t *v) {
-    if (items->type != VAL_ARRAY) {
+    val_array_unshare(items);
+
+    val_type_t type = val_type_of(items);
+
+    if (type == VAL_INT_ARRAY) {
+        if (v != NULL && val_type_of(v) == VAL_INT) {
+            array_push_i64(&items->array, val_as_i64(v));
+            free_val_if_ok(v);
+
+            return NULL;
+        }
+
+        // An empty int array has not committed to anything yet.
+        if (items->array.len == 0 && v != NULL && val_type_of(v) == VAL_FLOAT) {
+            val_retype(items, VAL_FLOAT_ARRAY);
+            array_push_f64(&items->array, v->f64);
+            free_val_if_ok(v);
+
+            return NULL;
+        }
+
+        val_array_unbox(items);
+    } else if (type == VAL_FLOAT_ARRAY) {
+        if (v != NULL && val_type_of(v) == VAL_FLOAT) {
+            array_push_f64(&items->array, v->f64);
+            free_val_if_ok(v);
+
+            return NULL;
+        }
+
+        val_array_unbox(items);
+    } else if (type != VAL_ARRAY) {
         assert(false);
     }
 
@@ -335,24 +719,539 @@ void *val_array_push(val_t *items, val_t *v) {
     return NULL;
 }
 
+// Bulk reduction/mutation entry points. Unboxed arrays run the simd.h
+// kernels over their contiguous buffers; boxed arrays fall back to a
+// scalar walk so the compiler can emit these unconditionally for
+// recognized reduction loops.
+
+val_t *val_array_sum(val_t *items) {
+    val_type_t type = val_type_of(items);
+    val_t *result;
+
+    if (type == VAL_INT_ARRAY) {
+        result = new_int_val(simd_sum_i64((int64_t *) items->array.data, items->array.len));
+    } else if (type == VAL_FLOAT_ARRAY) {
+        result = new_float_val(simd_sum_f64((double *) items->array.data, items->array.len));
+    } else if (type == VAL_ARRAY) {
+        int64_t int_sum = 0;
+        double float_sum = 0;
+        bool is_float = false;
+
+        for (size_t i = 0; i < items->array.len; i++) {
+            val_t *e = (val_t *) items->array.data[i];
+
+            if (val_type_of(e) == VAL_INT) {
+                int_sum += val_as_i64(e);
+            } else if (val_type_of(e) == VAL_FLOAT) {
+                is_float = true;
+                float_sum += e->f64;
+            } else {
+                assert(false);
+            }
+        }
+
+        result = is_float ? new_float_val(float_sum + (double) int_sum) : new_int_val(int_sum);
+    } else {
+        assert(false);
+        result = NULL;
+    }
+
+    free_val_if_ok(items);
+
+    return result;
+}
+
+static val_t *val_array_minmax(val_t *items, bool want_max) {
+    val_type_t type = val_type_of(items);
+    val_t *result;
+
+    if (items->array.len == 0) {
+        free_val_if_ok(items);
+
+        return new_null_val();
+    }
+
+    if (type == VAL_INT_ARRAY) {
+        result = new_int_val(simd_minmax_i64((int64_t *) items->array.data, items->array.len, want_max));
+    } else if (type == VAL_FLOAT_ARRAY) {
+        result = new_float_val(simd_minmax_f64((double *) items->array.data, items->array.len, want_max));
+    } else if (type == VAL_ARRAY) {
+        val_t *best = (val_t *) items->array.data[0];
+
+        for (size_t i = 1; i < items->array.len; i++) {
+            val_t *e = (val_t *) items->array.data[i];
+            short status = val_compare(e, best);
+
+            if (want_max ? status > 0 : status < 0) {
+                best = e;
+            }
+        }
+
+        if (val_type_of(best) == VAL_INT) {
+            result = new_int_val(val_as_i64(best));
+        } else {
+            result = new_float_val(best->f64);
+        }
+    } else {
+        assert(false);
+        result = NULL;
+    }
+
+    free_val_if_ok(items);
+
+    return result;
+}
+
+val_t *val_array_min(val_t *items) {
+    return val_array_minmax(items, false);
+}
+
+val_t *val_array_max(val_t *items) {
+    return val_array_minmax(items, true);
+}
+
+void *val_array_scale(val_t *items, val_t *factor) {
+    val_array_unshare(items);
+
+    val_type_t type = val_type_of(items);
+    val_type_t factor_type = val_type_of(factor);
+
+    if (factor_type != VAL_INT && factor_type != VAL_FLOAT) {
+        assert(false);
+    }
+
+    if (type == VAL_INT_ARRAY) {
+        if (factor_type == VAL_INT) {
+            simd_scale_i64((int64_t *) items->array.data, items->array.len, val_as_i64(factor));
+        } else {
+            // A float factor pulls the whole array into the float form.
+            simd_widen_i64_f64(items->array.data, items->array.len);
+            val_retype(items, VAL_FLOAT_ARRAY);
+            simd_scale_f64((double *) items->array.data, items->array.len, factor->f64);
+        }
+    } else if (type == VAL_FLOAT_ARRAY) {
+        double f = (factor_type == VAL_INT) ? (double) val_as_i64(factor) : factor->f64;
+
+        simd_scale_f64((double *) items->array.data, items->array.len, f);
+    } else if (type == VAL_ARRAY) {
+        for (size_t i = 0; i < items->array.len; i++) {
+            val_t *e = (val_t *) items->array.data[i];
+            val_t *scaled;
+
+            if (val_type_of(e) == VAL_INT && factor_type == VAL_INT) {
+                scaled = new_int_val(val_as_i64(e) * val_as_i64(factor));
+            } else if (val_type_of(e) == VAL_INT) {
+                scaled = new_float_val((double) val_as_i64(e) * factor->f64);
+            } else if (val_type_of(e) == VAL_FLOAT) {
+                double f = (factor_type == VAL_INT) ? (double) val_as_i64(factor) : factor->f64;
+
+                scaled = new_float_val(e->f64 * f);
+            } else {
+                assert(false);
+                scaled = NULL;
+            }
+
+            items->array.data[i] = scaled;
+            link_val(scaled);
+            unlink_val(e);
+        }
+    } else {
+        assert(false);
+    }
+
+    free_val_if_ok(factor);
+
+    return NULL;
+}
+
+void *val_array_fill(val_t *items, val_t *v) {
+    val_array_unshare(items);
+
+    val_type_t type = val_type_of(items);
+
+    if (type == VAL_INT_ARRAY || type == VAL_FLOAT_ARRAY) {
+        val_type_t value_type = v != NULL ? val_type_of(v) : VAL_NULL;
+
+        // Every element is overwritten, so the array simply takes the
+        // representation of the fill value.
+        if (value_type == VAL_INT) {
+            val_retype(items, VAL_INT_ARRAY);
+            simd_fill_i64((int64_t *) items->array.data, items->array.len, val_as_i64(v));
+
+            free_val_if_ok(v);
+
+            return NULL;
+        }
+
+        if (value_type == VAL_FLOAT) {
+            val_retype(items, VAL_FLOAT_ARRAY);
+            simd_fill_f64((double *) items->array.data, items->array.len, v->f64);
+
+            free_val_if_ok(v);
+
+            return NULL;
+        }
+
+        val_array_unbox(items);
+    } else if (type != VAL_ARRAY) {
+        assert(false);
+    }
+
+    for (size_t i = 0; i < items->array.len; i++) {
+        val_t *e = (val_t *) items->array.data[i];
+
+        items->array.data[i] = v;
+        link_val(v);
+        unlink_val(e);
+    }
+
+    free_val_if_ok(v);
+
+    return NULL;
+}
+
+static bool val_is_array_kind(val_t *v) {
+    val_type_t type = val_type_of(v);
+
+    return type == VAL_ARRAY || type == VAL_INT_ARRAY || type == VAL_FLOAT_ARRAY;
+}
+
+// Capacity hint for call sites that know how many pushes follow (array
+// literals, rest arguments); one grow up front instead of a realloc
+// ladder.
+void *val_array_reserve(val_t *items, int64_t n) {
+    if (!val_is_array_kind(items)) {
+        assert(false);
+    }
+
+    if (n > 0) {
+        val_array_unshare(items);
+        array_reserve(&items->array, (size_t) n);
+    }
+
+    return NULL;
+}
+
+// Appends src's elements to dst in bulk: matching representations are one
+// memcpy, int->float widens, and mixed boxed/unboxed falls back to boxing.
+// With steal set (boxed src that is being consumed and has no other
+// owners) the pointer block moves without touching any ref_count.
+static void val_array_extend_into(val_t *dst, val_t *src, bool steal) {
+    size_t n = src->array.len;
+
+    if (n == 0) {
+        return;
+    }
+
+    val_type_t dst_type = val_type_of(dst);
+    val_type_t src_type = val_type_of(src);
+
+    if (dst_type == VAL_INT_ARRAY && src_type == VAL_FLOAT_ARRAY) {
+        simd_widen_i64_f64(dst->array.data, dst->array.len);
+        val_retype(dst, VAL_FLOAT_ARRAY);
+        dst_type = VAL_FLOAT_ARRAY;
+    } else if (dst_type != VAL_ARRAY && src_type == VAL_ARRAY) {
+        val_array_unbox(dst);
+        dst_type = VAL_ARRAY;
+    }
+
+    array_reserve(&dst->array, n);
+
+    if (dst_type == VAL_INT_ARRAY && src_type == VAL_INT_ARRAY) {
+        memcpy((int64_t *) dst->array.data + dst->array.len, src->array.data, n * sizeof(int64_t));
+        dst->array.len += n;
+    } else if (dst_type == VAL_FLOAT_ARRAY) {
+        if (src_type == VAL_FLOAT_ARRAY) {
+            memcpy((double *) dst->array.data + dst->array.len, src->array.data, n * sizeof(double));
+            dst->array.len += n;
+        } else {
+            double *out = (double *) dst->array.data + dst->array.len;
+            int64_t *in = (int64_t *) src->array.data;
+
+            for (size_t i = 0; i < n; i++) {
+                out[i] = (double) in[i];
+            }
+
+            dst->array.len += n;
+        }
+    } else if (dst_type == VAL_ARRAY && src_type == VAL_ARRAY) {
+        memcpy(dst->array.data + dst->array.len, src->array.data, n * sizeof(void *));
+        dst->array.len += n;
+
+        if (!steal) {
+            for (size_t i = 0; i < n; i++) {
+                link_val((val_t *) src->array.data[i]);
+            }
+        }
+    } else {
+        // dst is boxed, src unboxed: box each element (tagged for ints).
+        for (size_t i = 0; i < n; i++) {
+            val_t *e;
+
+            if (src_type == VAL_INT_ARRAY) {
+                e = new_int_val(((int64_t *) src->array.data)[i]);
+            } else {
+                e = new_float_val(((double *) src->array.data)[i]);
+            }
+
+            array_push(&dst->array, e);
+            link_val(e);
+        }
+    }
+}
+
+// Releases a consumed source array. When its pointer block was stolen the
+// shell is dropped directly so the moved children keep their ref counts.
+static void val_array_release(val_t *src, bool stolen) {
+    if (stolen) {
+        free_array(&src->array);
+        pool_free_val(src);
+    } else {
+        free_val_if_ok(src);
+    }
+}
+
+static bool val_array_can_steal(val_t *src) {
+    return val_type_of(src) == VAL_ARRAY && !val_is_static(src) && val_ref_count(src) == 0 && src->array.shared == NULL;
+}
+
+val_t *val_array_concat(val_t *v1, val_t *v2) {
+    if (!val_is_array_kind(v1) || !val_is_array_kind(v2)) {
+        assert(false);
+    }
+
+    val_t *result = new_array_val(v1->array.len + v2->array.len);
+
+    bool steal1 = val_array_can_steal(v1);
+    val_array_extend_into(result, v1, steal1);
+    val_array_release(v1, steal1);
+
+    bool steal2 = val_array_can_steal(v2);
+    val_array_extend_into(result, v2, steal2);
+    val_array_release(v2, steal2);
+
+    return result;
+}
+
+void *val_array_extend(val_t *dst, val_t *src) {
+    if (!val_is_array_kind(dst) || !val_is_array_kind(src)) {
+        assert(false);
+    }
+
+    val_array_unshare(dst);
+
+    bool steal = val_array_can_steal(src);
+    val_array_extend_into(dst, src, steal);
+    val_array_release(src, steal);
+
+    return NULL;
+}
+
+val_t *val_array_slice(val_t *items, val_t *start, val_t *end) {
+    if (!val_is_array_kind(items)) {
+        assert(false);
+    }
+
+    int64_t from = val_as_i64(start);
+    int64_t to = val_as_i64(end);
+
+    if (from < 0) {
+        from = 0;
+    }
+    if (to > (int64_t) items->array.len) {
+        to = (int64_t) items->array.len;
+    }
+    if (from > to) {
+        from = to;
+    }
+
+    size_t n = (size_t) (to - from);
+    val_t *result = new_array_val(n);
+
+    val_retype(result, val_type_of(items));
+    memcpy(result->array.data, (char **) items->array.data + from, n * sizeof(void *));
+    result->array.len = n;
+
+    if (result->type == VAL_ARRAY) {
+        for (size_t i = 0; i < n; i++) {
+            link_val((val_t *) result->array.data[i]);
+        }
+    }
+
+    free_val_if_ok(start);
+    free_val_if_ok(end);
+    free_val_if_ok(items);
+
+    return result;
+}
+
+// O(1) clone: the new box views the same data block through a COW
+// header (cow.h); whichever side mutates first pays for the copy then.
+// Inline arrays just copy their couple of elements instead.
+val_t *val_array_clone(val_t *items) {
+    if (!val_is_array_kind(items)) {
+        assert(false);
+    }
+
+    val_t *result = new_val(items->type);
+    array_t *src = &items->array;
+    array_t *dst = &result->array;
+
+    if (array_is_inline(src)) {
+        dst->capacity = ARRAY_INLINE_CAPACITY;
+        dst->len = src->len;
+        dst->data = dst->inline_data;
+        dst->shared = NULL;
+
+        memcpy(dst->inline_data, src->inline_data, src->len * sizeof(void *));
+
+        if (items->type == VAL_ARRAY) {
+            for (size_t i = 0; i < dst->len; i++) {
+                link_val((val_t *) dst->data[i]);
+            }
+        }
+    } else {
+        if (src->shared == NULL) {
+            src->shared = cow_buf_new(src->data);
+        }
+
+        cow_buf_retain(src->shared);
+
+        dst->capacity = src->capacity;
+        dst->len = src->len;
+        dst->data = src->data;
+        dst->shared = src->shared;
+    }
+
+    DEBUG("ARRAY: clone: %p -> %p, len: %zu", items, result, dst->len);
+
+    free_val_if_ok(items);
+
+    return result;
+}
+
+// Object counterpart of val_array_unshare: duplicates a COW-shared vals
+// block before a write; vals are always boxed, so each gains one
+// reference for the new block.
+static void val_object_unshare(val_t *kv) {
+    cow_buf_t *shared = kv->object.shared;
+
+    if (shared == NULL) {
+        return;
+    }
+
+    if (cow_buf_release(shared)) {
+        kv->object.shared = NULL;
+
+        return;
+    }
+
+    object_t *o = &kv->object;
+    void **vals = mini_alloc(o->capacity * sizeof(void *));
+
+    STATS_ADD(stats_object_bytes, o->capacity * sizeof(void *));
+
+    memcpy(vals, o->vals, o->len * sizeof(void *));
+
+    o->vals = vals;
+    o->shared = NULL;
+
+    for (size_t i = 0; i < o->len; i++) {
+        link_val((val_t *) o->vals[i]);
+    }
+
+    DEBUG("OBJECT: unshare: %p, len: %zu", kv, o->len);
+}
+
+// O(1) clone: shares the shape (by construction) and the vals block
+// through a COW header; the first write to either side copies.
+val_t *val_object_clone(val_t *kv) {
+    if (val_type_of(kv) != VAL_OBJECT) {
+        assert(false);
+    }
+
+    val_t *result = new_val(VAL_OBJECT);
+    object_t *src = &kv->object;
+    object_t *dst = &result->object;
+
+    if (src->shared == NULL) {
+        src->shared = cow_buf_new(src->vals);
+    }
+
+    cow_buf_retain(src->shared);
+
+    dst->shape = src->shape;
+    dst->capacity = src->capacity;
+    dst->len = src->len;
+    dst->vals = src->vals;
+    dst->shared = src->shared;
+
+    DEBUG("OBJECT: clone: %p -> %p, len: %zu", kv, result, dst->len);
+
+    free_val_if_ok(kv);
+
+    return result;
+}
+
 void *val_object_set(val_t *kv, char *k, val_t *v) {
-    if (kv->type != VAL_OBJECT) {
+    if (val_type_of(kv) != VAL_OBJECT) {
         assert(false);
     }
 
-    object_set(&kv->object, k, v);
+    val_object_unshare(kv);
+
+    val_t *old = object_set(&kv->object, k, v);
 
     link_val(v);
 
+    if (old != NULL) {
+        unlink_val(old);
+    }
+
     return NULL;
 }
 
 void *val_object_get(val_t *kv, char *k) {
-    if (kv->type != VAL_OBJECT) {
+    if (val_type_of(kv) != VAL_OBJECT) {
         assert(false);
     }
 
     return object_get(&kv->object, k);
 }
 
+// Per-call-site inline cache for property reads: the cache remembers the
+// last shape and slot seen at its site, so a monomorphic read is one
+// pointer compare and one indexed load. The compiler reserves one of
+// these per access site and passes its address.
+typedef struct {
+    object_shape_t *shape;
+    uint32_t slot;
+} object_ic_t;
+
+void *val_object_get_ic(val_t *kv, char *k, object_ic_t *ic) {
+    if (val_type_of(kv) != VAL_OBJECT) {
+        assert(false);
+    }
+
+    object_t *o = &kv->object;
+
+    if (ic->shape == o->shape) {
+        return o->vals[ic->slot];
+    }
+
+    uint32_t hash;
+    k = intern_key(k, &hash);
+
+    uint32_t slot = shape_find(o->shape, k, hash);
+
+    if (slot == OBJECT_SLOT_EMPTY) {
+        return NULL;
+    }
+
+    ic->shape = o->shape;
+    ic->slot = slot;
+
+    return o->vals[slot];
+}
+
 #endif
@@ -0,0 +1,92 @@
+#ifndef MINI_STD_PARALLEL_H
+#define MINI_STD_PARALLEL_H
+
+#include "defs.h"
+
+#ifdef MINI_THREADS
+
+#include <pthread.h>
+
+// Ownership rule for values crossing threads: the dispatching thread
+// owns the input array and keeps it alive for the whole call; workers
+// see elements read-only and must link_val anything they retain beyond
+// their callback. Values a worker produces come from its thread-local
+// pool and are handed back owned by the result array. Freeing a value on
+// a different thread than the one that allocated it is safe — the slot
+// simply joins the freeing thread's free list.
+
+#define PARALLEL_WORKERS 4
+
+typedef struct {
+    val_t *items;
+    val_t *result;
+    val_t *(*fn)(val_t *);
+    size_t from;
+    size_t to;
+} parallel_map_task_t;
+
+static void *parallel_map_worker(void *arg) {
+    parallel_map_task_t *task = arg;
+
+    for (size_t i = task->from; i < task->to; i++) {
+        val_t *e = (val_t *) task->items->array.data[i];
+        val_t *r = task->fn(e);
+
+        task->result->array.data[i] = r;
+        link_val(r);
+    }
+
+    return NULL;
+}
+
+// Applies fn to every element on a small worker pool and returns the new
+// array; the input is consumed like the other val_array entry points.
+val_t *val_array_parallel_map(val_t *items, val_t *(*fn)(val_t *)) {
+    if (!val_is_array_kind(items)) {
+        assert(false);
+    }
+
+    if (val_type_of(items) != VAL_ARRAY) {
+        val_array_unbox(items);
+    }
+
+    size_t len = items->array.len;
+
+    val_t *result = new_array_val(len);
+    val_retype(result, VAL_ARRAY);
+    result->array.len = len;
+
+    size_t workers = len < PARALLEL_WORKERS ? len : PARALLEL_WORKERS;
+
+    if (workers > 1) {
+        pthread_t threads[PARALLEL_WORKERS];
+        parallel_map_task_t tasks[PARALLEL_WORKERS];
+        size_t chunk = (len + workers - 1) / workers;
+
+        for (size_t w = 0; w < workers; w++) {
+            tasks[w].items = items;
+            tasks[w].result = result;
+            tasks[w].fn = fn;
+            tasks[w].from = w * chunk;
+            tasks[w].to = (w + 1) * chunk < len ? (w + 1) * chunk : len;
+
+            pthread_create(&threads[w], NULL, parallel_map_worker, &tasks[w]);
+        }
+
+        for (size_t w = 0; w < workers; w++) {
+            pthread_join(threads[w], NULL);
+        }
+    } else {
+        parallel_map_task_t task = {items, result, fn, 0, len};
+
+        parallel_map_worker(&task);
+    }
+
+    free_val_if_ok(items);
+
+    return result;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef MINI_STD_POOL_H
+#define MINI_STD_POOL_H
+
+#include "defs.h"
+#include "stats.h"
+
+#define POOL_CHUNK_SLOTS 4096
+
+typedef union pool_slot {
+    union pool_slot *next;
+    val_t val;
+} pool_slot_t;
+
+typedef struct pool_chunk {
+    struct pool_chunk *next;
+    pool_slot_t slots[POOL_CHUNK_SLOTS];
+} pool_chunk_t;
+
+static MINI_TLS pool_chunk_t *pool_chunks = NULL;
+static MINI_TLS pool_slot_t *pool_free_list = NULL;
+static MINI_TLS size_t pool_bump = POOL_CHUNK_SLOTS;
+
+static val_t *pool_alloc_val() {
+    if (pool_free_list != NULL) {
+        pool_slot_t *slot = pool_free_list;
+        pool_free_list = slot->next;
+
+        return &slot->val;
+    }
+
+    if (pool_bump == POOL_CHUNK_SLOTS) {
+        pool_chunk_t *chunk = malloc(sizeof(pool_chunk_t));
+        chunk->next = pool_chunks;
+
+        pool_chunks = chunk;
+        pool_bump = 0;
+
+        DEBUG("POOL: new chunk: %p", chunk);
+    }
+
+    return &pool_chunks->slots[pool_bump++].val;
+}
+
+static void pool_free_val(val_t *val) {
+    stats_count_free(val->type);
+
+    pool_slot_t *slot = (pool_slot_t *) val;
+
+    slot->next = pool_free_list;
+    pool_free_list = slot;
+}
+
+#endif
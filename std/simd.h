@@ -0,0 +1,210 @@
+#ifndef MINI_STD_SIMD_H
+#define MINI_STD_SIMD_H
+
+#include "defs.h"
+
+// Raw kernels over the contiguous buffers of unboxed arrays. Built on
+// GCC/clang portable vector extensions (4x64-bit lanes, one AVX register)
+// with scalar tails; other compilers get the plain loops.
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_VECTORS 1
+
+typedef int64_t simd_i64x4 __attribute__((vector_size(32)));
+typedef double simd_f64x4 __attribute__((vector_size(32)));
+#endif
+
+static int64_t simd_sum_i64(const int64_t *data, size_t len) {
+    int64_t sum = 0;
+    size_t i = 0;
+
+#ifdef SIMD_VECTORS
+    simd_i64x4 acc = {0, 0, 0, 0};
+
+    for (; i + 4 <= len; i += 4) {
+        simd_i64x4 v;
+        memcpy(&v, data + i, sizeof(v));
+        acc += v;
+    }
+
+    sum = acc[0] + acc[1] + acc[2] + acc[3];
+#endif
+
+    for (; i < len; i++) {
+        sum += data[i];
+    }
+
+    return sum;
+}
+
+static double simd_sum_f64(const double *data, size_t len) {
+    double sum = 0;
+    size_t i = 0;
+
+#ifdef SIMD_VECTORS
+    simd_f64x4 acc = {0, 0, 0, 0};
+
+    for (; i + 4 <= len; i += 4) {
+        simd_f64x4 v;
+        memcpy(&v, data + i, sizeof(v));
+        acc += v;
+    }
+
+    sum = acc[0] + acc[1] + acc[2] + acc[3];
+#endif
+
+    for (; i < len; i++) {
+        sum += data[i];
+    }
+
+    return sum;
+}
+
+static int64_t simd_minmax_i64(const int64_t *data, size_t len, bool want_max) {
+    int64_t result = data[0];
+    size_t i = 1;
+
+#ifdef SIMD_VECTORS
+    if (len >= 4) {
+        simd_i64x4 acc;
+        memcpy(&acc, data, sizeof(acc));
+
+        for (i = 4; i + 4 <= len; i += 4) {
+            simd_i64x4 v;
+            memcpy(&v, data + i, sizeof(v));
+
+            simd_i64x4 keep = want_max ? (v > acc) : (v < acc);
+            acc = (v & keep) | (acc & ~keep);
+        }
+
+        result = acc[0];
+        for (int lane = 1; lane < 4; lane++) {
+            if (want_max ? acc[lane] > result : acc[lane] < result) {
+                result = acc[lane];
+            }
+        }
+    }
+#endif
+
+    for (; i < len; i++) {
+        if (want_max ? data[i] > result : data[i] < result) {
+            result = data[i];
+        }
+    }
+
+    return result;
+}
+
+static double simd_minmax_f64(const double *data, size_t len, bool want_max) {
+    double result = data[0];
+    size_t i = 1;
+
+#ifdef SIMD_VECTORS
+    if (len >= 4) {
+        simd_f64x4 acc;
+        memcpy(&acc, data, sizeof(acc));
+
+        for (i = 4; i + 4 <= len; i += 4) {
+            simd_f64x4 v;
+            memcpy(&v, data + i, sizeof(v));
+
+            simd_i64x4 keep = want_max ? (v > acc) : (v < acc);
+            acc = (simd_f64x4) (((simd_i64x4) v & keep) | ((simd_i64x4) acc & ~keep));
+        }
+
+        result = acc[0];
+        for (int lane = 1; lane < 4; lane++) {
+            if (want_max ? acc[lane] > result : acc[lane] < result) {
+                result = acc[lane];
+            }
+        }
+    }
+#endif
+
+    for (; i < len; i++) {
+        if (want_max ? data[i] > result : data[i] < result) {
+            result = data[i];
+        }
+    }
+
+    return result;
+}
+
+static void simd_scale_i64(int64_t *data, size_t len, int64_t factor) {
+    size_t i = 0;
+
+#ifdef SIMD_VECTORS
+    for (; i + 4 <= len; i += 4) {
+        simd_i64x4 v;
+        memcpy(&v, data + i, sizeof(v));
+        v *= factor;
+        memcpy(data + i, &v, sizeof(v));
+    }
+#endif
+
+    for (; i < len; i++) {
+        data[i] *= factor;
+    }
+}
+
+static void simd_scale_f64(double *data, size_t len, double factor) {
+    size_t i = 0;
+
+#ifdef SIMD_VECTORS
+    for (; i + 4 <= len; i += 4) {
+        simd_f64x4 v;
+        memcpy(&v, data + i, sizeof(v));
+        v *= factor;
+        memcpy(data + i, &v, sizeof(v));
+    }
+#endif
+
+    for (; i < len; i++) {
+        data[i] *= factor;
+    }
+}
+
+static void simd_fill_i64(int64_t *data, size_t len, int64_t value) {
+    size_t i = 0;
+
+#ifdef SIMD_VECTORS
+    simd_i64x4 v = {value, value, value, value};
+
+    for (; i + 4 <= len; i += 4) {
+        memcpy(data + i, &v, sizeof(v));
+    }
+#endif
+
+    for (; i < len; i++) {
+        data[i] = value;
+    }
+}
+
+static void simd_fill_f64(double *data, size_t len, double value) {
+    size_t i = 0;
+
+#ifdef SIMD_VECTORS
+    simd_f64x4 v = {value, value, value, value};
+
+    for (; i + 4 <= len; i += 4) {
+        memcpy(data + i, &v, sizeof(v));
+    }
+#endif
+
+    for (; i < len; i++) {
+        data[i] = value;
+    }
+}
+
+// Widens an int64 buffer to doubles in place (the element size matches),
+// used when an int array meets a float operand.
+static void simd_widen_i64_f64(void *data, size_t len) {
+    int64_t *src = (int64_t *) data;
+    double *dst = (double *) data;
+
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = (double) src[i];
+    }
+}
+
+#endif
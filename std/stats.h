@@ -0,0 +1,110 @@
+#ifndef MINI_STD_STATS_H
+#define MINI_STD_STATS_H
+
+#include "defs.h"
+
+// Allocation statistics. The counters are always maintained — they are
+// plain increments on paths that already touch the allocator — and the
+// end-of-run report only appears when the process runs with
+// MINI_STATS=1, so production binaries can be inspected without a
+// rebuild. Still-live boxes at exit are dumped as a per-type histogram.
+
+#define STATS_TYPE_COUNT (VAL_FLOAT_ARRAY + 1)
+
+// Under MINI_THREADS the counters go atomic; the peak tracking is a
+// relaxed read-compare and stays approximate across threads.
+#ifdef MINI_THREADS
+#define STATS_ADD(counter, n) __atomic_add_fetch(&(counter), (n), __ATOMIC_RELAXED)
+#define STATS_SUB(counter, n) __atomic_sub_fetch(&(counter), (n), __ATOMIC_RELAXED)
+#define STATS_LOAD(counter) __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+#define STATS_STORE(counter, v) __atomic_store_n(&(counter), (v), __ATOMIC_RELAXED)
+#else
+#define STATS_ADD(counter, n) ((counter) += (n))
+#define STATS_SUB(counter, n) ((counter) -= (n))
+#define STATS_LOAD(counter) (counter)
+#define STATS_STORE(counter, v) ((counter) = (v))
+#endif
+
+static int64_t stats_live[STATS_TYPE_COUNT];
+static int64_t stats_total[STATS_TYPE_COUNT];
+static int64_t stats_peak[STATS_TYPE_COUNT];
+
+static int64_t stats_str_bytes = 0;
+static int64_t stats_array_bytes = 0;
+static int64_t stats_object_bytes = 0;
+static int64_t stats_array_reallocs = 0;
+
+static const char *stats_type_names[STATS_TYPE_COUNT] = {
+    "null", "bool", "int", "float", "str", "array", "object", "int_array", "float_array",
+};
+
+static inline void stats_count_alloc(val_type_t type) {
+    int64_t live = STATS_ADD(stats_live[type], 1);
+
+    STATS_ADD(stats_total[type], 1);
+
+    if (live > STATS_LOAD(stats_peak[type])) {
+        STATS_STORE(stats_peak[type], live);
+    }
+}
+
+static inline void stats_count_free(val_type_t type) {
+    STATS_SUB(stats_live[type], 1);
+}
+
+// Arrays change representation in place (unbox, int -> float widening);
+// retyping through this keeps the live histogram keyed by the box's
+// current type.
+static inline void val_retype(val_t *v, val_type_t type) {
+    STATS_SUB(stats_live[v->type], 1);
+
+    int64_t live = STATS_ADD(stats_live[type], 1);
+
+    if (live > STATS_LOAD(stats_peak[type])) {
+        STATS_STORE(stats_peak[type], live);
+    }
+
+    v->type = type;
+}
+
+static void stats_report(void) {
+    int64_t live_total = 0;
+
+    fprintf(stderr, "== mini heap stats ==\n");
+
+    for (int t = 0; t < STATS_TYPE_COUNT; t++) {
+        if (stats_total[t] > 0) {
+            fprintf(stderr, "%12s  live %8lld  peak %8lld  total %12lld\n",
+                    stats_type_names[t], (long long) stats_live[t],
+                    (long long) stats_peak[t], (long long) stats_total[t]);
+        }
+
+        live_total += stats_live[t];
+    }
+
+    fprintf(stderr, "   str bytes  %lld\n", (long long) stats_str_bytes);
+    fprintf(stderr, " array bytes  %lld  (grow reallocs %lld)\n",
+            (long long) stats_array_bytes, (long long) stats_array_reallocs);
+    fprintf(stderr, "object bytes  %lld\n", (long long) stats_object_bytes);
+
+    if (live_total > 0) {
+        fprintf(stderr, "leaked boxes: %lld\n", (long long) live_total);
+
+        for (int t = 0; t < STATS_TYPE_COUNT; t++) {
+            if (stats_live[t] > 0) {
+                fprintf(stderr, "%12s  %lld\n", stats_type_names[t], (long long) stats_live[t]);
+            }
+        }
+    }
+}
+
+__attribute__((constructor))
+static void stats_init(void) {
+    char *env = getenv("MINI_STATS");
+
+    if (env != NULL && strcmp(env, "1") == 0) {
+        atexit(stats_report);
+    }
+}
+
+#endif
@@ -5,19 +5,22 @@
 #include <stdint.h>
 #include <string.h>
 
-#define DEBUG_MODE true
-
-#if DEBUG_MODE
+// Tracing is opt-in: build with -DMINI_DEBUG to get the per-operation
+// stderr log. In the default build DEBUG compiles to nothing, so hot
+// paths carry no formatting, no branch and no stderr traffic. For cheap
+// production instrumentation see counters.h (-DMINI_COUNTERS).
+#ifdef MINI_DEBUG
     #define DEBUG(args...) { \
         fprintf(stderr, "   > "); \
         fprintf(stderr, ##args); \
         fprintf(stderr, "\n"); \
     };
 #else
-	#define DEBUG(args...) {};
+    #define DEBUG(args...) {};
 #endif
 
 #include "defs.h"
 #include "val.h"
 #include "ops.h"
+#include "parallel.h"
 #include "echo.h"
@@ -2,27 +2,264 @@
 #define MINI_STD_STR_H
 
 #include "defs.h"
+#include "arena.h"
+#include "stats.h"
+
+static bool str_is_inline(str_t *s) {
+    return s->data == s->inline_data;
+}
+
+// Dead buffers in the common size classes (32..1024 payload bytes) are
+// kept on free lists and handed back to the next string of that size,
+// so steady-state string churn stays out of malloc/free entirely.
+#define STR_BUF_CLASS_MIN 32
+#define STR_BUF_CLASSES 6
+
+static MINI_TLS void *str_buf_free_lists[STR_BUF_CLASSES];
+
+static int str_buf_class(uint64_t capacity) {
+    uint64_t size = STR_BUF_CLASS_MIN;
+
+    for (int i = 0; i < STR_BUF_CLASSES; i++, size *= 2) {
+        if (capacity <= size) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static str_buf_t *str_buf_new(uint64_t capacity) {
+    STATS_ADD(stats_str_bytes, capacity);
+
+    int class_index = str_buf_class(capacity);
+
+    if (class_index >= 0) {
+        capacity = (uint64_t) STR_BUF_CLASS_MIN << class_index;
+
+        if (str_buf_free_lists[class_index] != NULL) {
+            str_buf_t *buf = str_buf_free_lists[class_index];
+            str_buf_free_lists[class_index] = *(void **) buf;
+
+            buf->capacity = capacity;
+            buf->ref_count = 1;
+            buf->hash = 0;
+
+            return buf;
+        }
+    }
+
+    str_buf_t *buf = mini_alloc(sizeof(str_buf_t) + capacity);
+    buf->capacity = capacity;
+    buf->ref_count = 1;
+    buf->hash = 0;
+
+    return buf;
+}
+
+// Buffer refcounts go atomic under MINI_THREADS like the val and COW
+// counts, so slice views of one shared buffer can be taken and released
+// from different threads without racing on the count.
+static void str_buf_retain(str_buf_t *buf) {
+#ifdef MINI_THREADS
+    __atomic_add_fetch(&buf->ref_count, 1, __ATOMIC_ACQ_REL);
+#else
+    buf->ref_count++;
+#endif
+}
+
+static uint32_t str_buf_ref_count(str_buf_t *buf) {
+#ifdef MINI_THREADS
+    return __atomic_load_n(&buf->ref_count, __ATOMIC_RELAXED);
+#else
+    return buf->ref_count;
+#endif
+}
+
+static void str_buf_release(str_buf_t *buf) {
+#ifdef MINI_THREADS
+    if (__atomic_sub_fetch(&buf->ref_count, 1, __ATOMIC_ACQ_REL) > 0) {
+        return;
+    }
+#else
+    if (--buf->ref_count > 0) {
+        return;
+    }
+#endif
+
+    int class_index = str_buf_class(buf->capacity);
+
+    if (class_index >= 0 && buf->capacity == (uint64_t) STR_BUF_CLASS_MIN << class_index) {
+        // The header doubles as the free-list link while the buffer is dead.
+        *(void **) buf = str_buf_free_lists[class_index];
+        str_buf_free_lists[class_index] = buf;
+    } else {
+        mini_free(buf);
+    }
+}
 
 static void free_str(str_t *s) {
-    free(s->data);
+    if (!str_is_inline(s)) {
+        str_buf_release(s->owner);
+    }
+}
+
+// Picks inline storage when len fits, a shared heap buffer otherwise.
+static char *str_alloc(str_t *result, uint64_t len) {
+    if (len < STR_INLINE_CAPACITY) {
+        result->capacity = STR_INLINE_CAPACITY;
+        result->data = result->inline_data;
+    } else {
+        str_buf_t *buf = str_buf_new(len + 1);
+
+        result->capacity = buf->capacity;
+        result->owner = buf;
+        result->data = buf->data;
+    }
+
+    result->len = len;
+
+    return result->data;
 }
 
 static void new_str(str_t *result, char *s) {
     uint64_t len = strlen(s);
-    char *data = malloc(len + 1);
-    memcpy(data, s, len + 1);
 
-    result->len = len;
-    result->data = data;
+    char *data = str_alloc(result, len);
+    memcpy(data, s, len + 1);
 }
 
 static void str_combine(str_t *result, str_t *s1, str_t *s2) {
-    char *data = malloc(s1->len + s2->len + 1);
+    char *data = str_alloc(result, s1->len + s2->len);
     memcpy(data, s1->data, s1->len);
-    memcpy(data + s1->len, s2->data, s2->len + 1);
+    memcpy(data + s1->len, s2->data, s2->len);
+    data[s1->len + s2->len] = 0;
+}
+
+// Materializes src->data[offset .. offset+len) into fresh storage, for
+// sources whose bytes cannot be shared: static literals (the type-name
+// singletons and the codegen constant pool) are views with no owning
+// buffer behind them, so their owner field must never be touched.
+static void str_slice_copy(str_t *result, str_t *src, uint64_t offset, uint64_t len) {
+    char *data = str_alloc(result, len);
+    memcpy(data, src->data + offset, len);
+    data[len] = 0;
+}
+
+// A view of src->data[offset .. offset+len): tiny slices are copied into
+// inline storage, anything else shares src's buffer with a ref bump and
+// no byte is copied. Views are immutable (capacity == 0); appending to
+// one spills into a fresh buffer first. The source must own or share a
+// real buffer — static sources go through str_slice_copy instead.
+static void str_slice(str_t *result, str_t *src, uint64_t offset, uint64_t len) {
+    if (len < STR_INLINE_CAPACITY || str_is_inline(src)) {
+        str_slice_copy(result, src, offset, len);
+
+        return;
+    }
+
+    str_buf_retain(src->owner);
+
+    result->len = len;
+    result->capacity = 0;
+    result->data = src->data + offset;
+    result->owner = src->owner;
+}
+
+static void str_grow(str_t *s, uint64_t capacity) {
+    // A uniquely-owned buffer past the recycled size classes can grow in
+    // place; everything else moves to a fresh (possibly recycled) buffer.
+    if (!str_is_inline(s) && str_buf_ref_count(s->owner) == 1 && s->data == s->owner->data
+        && str_buf_class(s->owner->capacity) < 0 && str_buf_class(capacity) < 0) {
+        s->owner = mini_realloc(s->owner, sizeof(str_buf_t) + s->owner->capacity, sizeof(str_buf_t) + capacity);
+        s->owner->capacity = capacity;
+        s->data = s->owner->data;
+    } else {
+        str_buf_t *buf = str_buf_new(capacity);
+
+        memcpy(buf->data, s->data, s->len);
+        buf->data[s->len] = 0;
+
+        if (!str_is_inline(s)) {
+            str_buf_release(s->owner);
+        }
+
+        s->owner = buf;
+        s->data = buf->data;
+        capacity = buf->capacity;
+    }
+
+    s->capacity = capacity;
+}
+
+// Appends src in place with amortized doubling, so chained concatenation
+// copies each byte once instead of re-copying the whole left side.
+static void str_append(str_t *result, str_t *src) {
+    uint64_t needed = result->len + src->len + 1;
+
+    if (result->capacity < needed) {
+        uint64_t capacity = result->capacity * 2;
+        if (capacity < needed) {
+            capacity = needed;
+        }
+
+        str_grow(result, capacity);
+    }
+
+    memcpy(result->data + result->len, src->data, src->len);
+    result->len += src->len;
+    result->data[result->len] = 0;
+
+    if (!str_is_inline(result) && result->capacity != 0) {
+        result->owner->hash = 0;
+    }
+}
+
+// FNV-1a over the string bytes; 0 is reserved for "not yet computed" and
+// the result is cached on the owning buffer when the string heads it
+// (slice views and inline strings hash per call).
+static uint32_t str_hash(str_t *s) {
+    bool cacheable = !str_is_inline(s) && s->capacity != 0 && s->data == s->owner->data;
+
+    if (cacheable && s->owner->hash != 0) {
+        return s->owner->hash;
+    }
+
+    uint32_t hash = 2166136261u;
+
+    for (uint64_t i = 0; i < s->len; i++) {
+        hash ^= (uint8_t) s->data[i];
+        hash *= 16777619;
+    }
+
+    if (hash == 0) {
+        hash = 1;
+    }
+
+    if (cacheable) {
+        s->owner->hash = hash;
+    }
+
+    return hash;
+}
+
+// Equality tries the cheap rejections first: the cached lengths, the
+// data pointer (shared buffers), then the cached hashes for strings long
+// enough that hashing beats the memcmp it saves.
+static bool str_eq(str_t *a, str_t *b) {
+    if (a->len != b->len) {
+        return false;
+    }
+
+    if (a->data == b->data) {
+        return true;
+    }
+
+    if (a->len >= STR_INLINE_CAPACITY && str_hash(a) != str_hash(b)) {
+        return false;
+    }
 
-    result->len = s1->len + s2->len;
-    result->data = data;
+    return memcmp(a->data, b->data, a->len) == 0;
 }
 
 #endif
@@ -9,20 +9,45 @@
 #include <string.h>
 
 #include "defs.h"
+#include "counters.h"
+#include "pool.h"
 #include "str.h"
 #include "array.h"
 #include "object.h"
 #include "gc.h"
 
-static val_t null_val = {VAL_NULL, 0};
-static val_t true_val = {VAL_BOOL, 0, .b = true};
-static val_t false_val = {VAL_BOOL, 0, .b = false};
+static val_t null_val = {VAL_NULL, VAL_STATIC_REF};
+static val_t true_val = {VAL_BOOL, VAL_STATIC_REF, .b = true};
+static val_t false_val = {VAL_BOOL, VAL_STATIC_REF, .b = false};
+
+// Static string singletons, the pattern for any builtin with a fixed
+// result set: link/unlink/free leave them alone like the singletons
+// above, and === on two of them is a pointer compare. The bytes live in
+// the literal (immutable view, capacity == 0); owner stays NULL, which
+// is safe because every name is shorter than STR_INLINE_CAPACITY, so no
+// slice or grow path ever reaches for the owning buffer.
+static val_t type_name_boolean_val = {VAL_STR, VAL_STATIC_REF, .str = {.len = 7, .capacity = 0, .data = "boolean"}};
+static val_t type_name_number_val = {VAL_STR, VAL_STATIC_REF, .str = {.len = 6, .capacity = 0, .data = "number"}};
+static val_t type_name_string_val = {VAL_STR, VAL_STATIC_REF, .str = {.len = 6, .capacity = 0, .data = "string"}};
+static val_t type_name_object_val = {VAL_STR, VAL_STATIC_REF, .str = {.len = 6, .capacity = 0, .data = "object"}};
+
+// Interned boxes for the ints generated code touches constantly (loop
+// counters, small constants). Only reachable when MINI_BOXED_INTS turns
+// the tagged-immediate encoding off; with tags on, this range never boxes.
+#define SMALL_INT_MIN -128
+#define SMALL_INT_MAX 1023
+
+static val_t small_int_vals[SMALL_INT_MAX - SMALL_INT_MIN + 1];
 
 static val_t *new_val(val_type_t type) {
-    val_t *result = malloc(sizeof(val_t));
+    COUNT(COUNTER_ALLOC);
+
+    val_t *result = pool_alloc_val();
     result->type = type;
     result->ref_count = 0;
 
+    stats_count_alloc(type);
+
     return result;
 }
 
@@ -35,6 +60,24 @@ val_t *new_bool_val(bool b) {
 }
 
 val_t *new_int_val(int64_t n) {
+#ifndef MINI_BOXED_INTS
+    if (n >= VAL_TAGGED_INT_MIN && n <= VAL_TAGGED_INT_MAX) {
+        return (val_t *) (((uint64_t) n << 1) | VAL_INT_TAG);
+    }
+#endif
+
+    if (n >= SMALL_INT_MIN && n <= SMALL_INT_MAX) {
+        val_t *result = &small_int_vals[n - SMALL_INT_MIN];
+
+        if (result->type != VAL_INT) {
+            result->type = VAL_INT;
+            result->ref_count = VAL_STATIC_REF;
+            result->i64 = n;
+        }
+
+        return result;
+    }
+
     val_t *result = new_val(VAL_INT);
     result->i64 = n;
 
@@ -62,7 +105,9 @@ val_t *new_str_val(char *s) {
 }
 
 val_t *new_array_val(uint64_t len) {
-    val_t *result = new_val(VAL_ARRAY);
+    // Arrays start in the unboxed int form; the first pushed element
+    // settles the real representation (see val_array_push).
+    val_t *result = new_val(VAL_INT_ARRAY);
     new_array(&result->array, len);
 
     DEBUG("new array: %zu, %p", result->array.len, result);
@@ -80,27 +125,17 @@ val_t *new_object_val() {
 }
 
 val_t *val_get_type(val_t *v) {
-    val_t *result = NULL;
-
-    switch (v->type) {
+    switch (val_type_of(v)) {
         case VAL_BOOL:
-            result = new_str_val("boolean");
-            break;
+            return &type_name_boolean_val;
         case VAL_INT:
-            result = new_str_val("number");
-            break;
         case VAL_FLOAT:
-            result = new_str_val("number");
-            break;
+            return &type_name_number_val;
         case VAL_STR:
-            result = new_str_val("string");
-            break;
+            return &type_name_string_val;
         default:
-            result = new_str_val("object");
-            break;
+            return &type_name_object_val;
     }
-
-    return result;
 }
 
 #endif